@@ -3,37 +3,124 @@
 
 #include <cstring>
 #include <iterator>
+#include <utility>
 
+#include "block_storage.h"
 #include "common.h"
 
 namespace coding
 {
-  // bit buffer of fixed maximal size with non-parallelizable sequential access
+  // bit buffer with non-parallelizable sequential access; of fixed maximal
+  //  size N or runtime-sized ( growing on write ) for N == dynamic_size; for
+  //  N == read_only_view it only reads external memory and all writing
+  //  members fail to compile
   template < std::size_t N >
   class bit_buffer
   {
   public:
-    bit_buffer() noexcept : m_curr_p( m_data_p ), m_end_p( m_data_p ) {}
+    bit_buffer() noexcept { reset(); }
+
+    explicit bit_buffer( std::size_t capacity ) :
+      m_storage( capacity ),
+      m_curr_p( m_storage.data() ),
+      m_end_p( m_storage.data() )
+    {
+      static_assert( N == dynamic_size, "capacity given for fixed size" );
+    }
+
+    // view of size bytes of encoded data in external memory
+    bit_buffer( byte *data_p, std::size_t size ) noexcept :
+      m_storage( data_p, size ),
+      m_curr_p( m_storage.data() ),
+      m_end_p( m_storage.data() + size )
+    {
+      static_assert( N == dynamic_size || read_only,
+                     "external memory for fixed size" );
+    }
+
+    // read-only view
+    bit_buffer( byte const *data_p, std::size_t size ) noexcept :
+      m_storage( data_p, size ),
+      m_curr_p( m_storage.data() ),
+      m_end_p( m_storage.data() + size )
+    {
+      static_assert( read_only, "read-only memory for writable buffer" );
+    }
+
     bit_buffer( bit_buffer const & ) = delete;
-    bit_buffer( bit_buffer && ) = delete;
+    bit_buffer( bit_buffer &&other ) noexcept { *this = std::move( other ); }
     bit_buffer &operator=( bit_buffer const & ) = delete;
-    bit_buffer &operator=( bit_buffer && ) = delete;
+
+    bit_buffer &operator=( bit_buffer &&other ) noexcept
+    {
+      auto curr = other.offset();
+      auto end = other.size();
+      m_storage = std::move( other.m_storage );
+      m_curr_p = m_storage.data() + curr;
+      m_end_p = m_storage.data() + end;
+      other.reset();
+      return *this;
+    }
+
     ~bit_buffer() noexcept = default;
 
     std::size_t size() const noexcept
     {
       return static_cast< std::size_t >(
         reinterpret_cast< std::uintptr_t >( m_end_p ) -
-        reinterpret_cast< std::uintptr_t >( m_data_p ) );
+        reinterpret_cast< std::uintptr_t >( m_storage.data() ) );
     }
 
-    std::size_t max_size() const noexcept { return N; }
+    std::size_t max_size() const noexcept { return m_storage.capacity(); }
+
+    byte const *data() const noexcept { return m_storage.data(); }
+
+    byte const *curr() const noexcept { return m_curr_p; }
+
+    // ensures room for n bytes in total; fails only for fixed size
+    bool reserve( std::size_t n )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      auto curr = offset();
+      auto end = size();
+      if ( !m_storage.reserve( n ) )
+      {
+        return false;
+      }
+      m_curr_p = m_storage.data() + curr;
+      m_end_p = m_storage.data() + end;
+      return true;
+    }
 
     void write( std::size_t n, const void *src_p )
     {
-      std::memcpy( static_cast< void * >( m_curr_p ), src_p, n );
+      static_assert( !read_only, "read-only view cannot be written" );
+      std::memcpy( static_cast< void * >( claim( n ) ), src_p, n );
+    }
+
+    // reserves n bytes at cursor for caller to fill and moves past them
+    byte *claim( std::size_t n )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      if constexpr ( N == dynamic_size )
+      {
+        if ( offset() + n > max_size() )
+        {
+          reserve( offset() + n );
+        }
+      }
+      auto result_p = m_curr_p;
       advance( n );
       m_end_p = m_curr_p;
+      return result_p;
+    }
+
+    // gives back last n bytes of preceding claim left unfilled by caller
+    void release( std::size_t n ) noexcept
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      reverse( n );
+      m_end_p = m_curr_p;
     }
 
     void write_word( word value )
@@ -41,12 +128,26 @@ namespace coding
       write( 2, static_cast< void * >( &value ) );
     }
 
+    template < typename T >
+    void write_value( T value )
+    {
+      write( sizeof( T ), static_cast< void * >( &value ) );
+    }
+
     void read( std::size_t n, void *dst_p ) noexcept
     {
-      std::memcpy( dst_p, static_cast< void * >( m_curr_p ), n );
+      std::memcpy( dst_p, static_cast< void const * >( m_curr_p ), n );
       advance( n );
     }
 
+    template < typename T >
+    T read_value()
+    {
+      T res;
+      read( sizeof( T ), static_cast< void * >( &res ) );
+      return res;
+    }
+
     word read_word()
     {
       word res;
@@ -57,7 +158,7 @@ namespace coding
     void read_reverse( std::size_t n, void *dst_p ) noexcept
     {
       reverse( n );
-      std::memcpy( dst_p, static_cast< void * >( m_curr_p ), n );
+      std::memcpy( dst_p, static_cast< void const * >( m_curr_p ), n );
     }
 
     word read_word_reverse()
@@ -67,10 +168,18 @@ namespace coding
       return res;
     }
 
+    template < typename T >
+    T read_value_reverse()
+    {
+      T res;
+      read_reverse( sizeof( T ), static_cast< void * >( &res ) );
+      return res;
+    }
+
     void reset() noexcept
     {
-      m_curr_p = m_data_p;
-      m_end_p = m_data_p;
+      m_curr_p = m_storage.data();
+      m_end_p = m_storage.data();
     }
 
     void advance( std::size_t offset ) noexcept
@@ -82,21 +191,38 @@ namespace coding
     void reverse( std::size_t offset ) noexcept
     {
       // std::printf( "===BB=== Reversing by %lu bytes.\n", offset );
-      std::advance( m_curr_p, -static_cast< int >( offset ) );
+      std::advance( m_curr_p, -static_cast< std::ptrdiff_t >( offset ) );
     }
 
-    void rewind() noexcept { m_curr_p = m_data_p; }
+    void rewind() noexcept { m_curr_p = m_storage.data(); }
+
+    void fast_forward() noexcept { m_curr_p = m_end_p; }
 
-    uint length() const noexcept { return static_cast< uint >( size() ) << 3u; }
+    ulong length() const noexcept
+    {
+      return static_cast< ulong >( size() ) << 3u;
+    }
 
     operator bool() const noexcept { return m_curr_p != m_end_p; }
 
-    bool is_beg() const noexcept { return m_curr_p == m_data_p; }
+    bool is_beg() const noexcept { return m_curr_p == m_storage.data(); }
+
+  private:
+    static constexpr bool read_only = N == read_only_view;
+
+    using pointer = std::conditional_t< read_only, byte const *, byte * >;
+
+    std::size_t offset() const noexcept
+    {
+      return static_cast< std::size_t >(
+        reinterpret_cast< std::uintptr_t >( m_curr_p ) -
+        reinterpret_cast< std::uintptr_t >( m_storage.data() ) );
+    }
 
   private:
-    byte m_data_p[ N ];
-    byte *m_curr_p;
-    byte *m_end_p;
+    block_storage< N > m_storage;
+    pointer m_curr_p;
+    pointer m_end_p;
   };
 
 }  // namespace coding
@@ -0,0 +1,5 @@
+#include "block_storage.h"
+
+namespace coding
+{
+}  // namespace coding
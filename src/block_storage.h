@@ -0,0 +1,170 @@
+#ifndef CODING_BLOCK_STORAGE_H_INCLUDED
+#define CODING_BLOCK_STORAGE_H_INCLUDED
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "common.h"
+
+namespace coding
+{
+  // size parameter selecting runtime-sized storage of data_block and
+  //  bit_buffer
+  constexpr std::size_t dynamic_size = 0u;
+
+  // size parameter selecting read-only view of external memory ( e.g. of
+  //  mapped file ); writing to such block or buffer does not compile
+  constexpr std::size_t read_only_view = ~std::size_t{ 0u };
+
+  // byte storage of fixed size embedded in owning object
+  template < std::size_t N >
+  class block_storage
+  {
+  public:
+    byte *data() noexcept { return m_data_p; }
+
+    byte const *data() const noexcept { return m_data_p; }
+
+    static constexpr std::size_t capacity() noexcept { return N; }
+
+    bool reserve( std::size_t n ) const noexcept { return n <= N; }
+
+    void clear() noexcept
+    {
+      std::memset( static_cast< void * >( m_data_p ), 0, N );
+    }
+
+  private:
+    byte m_data_p[ N ];
+  };
+
+  // runtime-sized byte storage, either owned on heap or referring to memory
+  //  provided by caller; external memory is copied to heap when it has to grow
+  template <>
+  class block_storage< dynamic_size >
+  {
+  public:
+    block_storage() noexcept = default;
+
+    explicit block_storage( std::size_t capacity ) :
+      m_owned_p( new byte[ capacity ]() ),
+      m_data_p( m_owned_p.get() ),
+      m_capacity( capacity )
+    {
+    }
+
+    block_storage( byte *data_p, std::size_t capacity ) noexcept :
+      m_data_p( data_p ), m_capacity( capacity )
+    {
+    }
+
+    block_storage( block_storage const & ) = delete;
+
+    block_storage( block_storage &&other ) noexcept :
+      m_owned_p( std::move( other.m_owned_p ) ),
+      m_data_p( std::exchange( other.m_data_p, nullptr ) ),
+      m_capacity( std::exchange( other.m_capacity, 0u ) )
+    {
+    }
+
+    block_storage &operator=( block_storage const & ) = delete;
+
+    block_storage &operator=( block_storage &&other ) noexcept
+    {
+      m_owned_p = std::move( other.m_owned_p );
+      m_data_p = std::exchange( other.m_data_p, nullptr );
+      m_capacity = std::exchange( other.m_capacity, 0u );
+      return *this;
+    }
+
+    ~block_storage() noexcept = default;
+
+    byte *data() noexcept { return m_data_p; }
+
+    byte const *data() const noexcept { return m_data_p; }
+
+    std::size_t capacity() const noexcept { return m_capacity; }
+
+    bool is_owning() const noexcept { return m_owned_p != nullptr; }
+
+    // grows to at least n bytes ( at least doubling ), keeping contents;
+    //  newly added bytes are zeroed
+    bool reserve( std::size_t n )
+    {
+      if ( n <= m_capacity )
+      {
+        return true;
+      }
+
+      auto capacity = std::max( n, m_capacity << 1u );
+      auto owned_p = std::unique_ptr< byte[] >( new byte[ capacity ]() );
+      if ( m_capacity > 0u )
+      {
+        std::memcpy( static_cast< void * >( owned_p.get() ),
+                     static_cast< void const * >( m_data_p ), m_capacity );
+      }
+      m_owned_p = std::move( owned_p );
+      m_data_p = m_owned_p.get();
+      m_capacity = capacity;
+      return true;
+    }
+
+    void clear() noexcept
+    {
+      if ( m_capacity > 0u )
+      {
+        std::memset( static_cast< void * >( m_data_p ), 0, m_capacity );
+      }
+    }
+
+  private:
+    std::unique_ptr< byte[] > m_owned_p;
+    byte *m_data_p = nullptr;
+    std::size_t m_capacity = 0u;
+  };
+
+  // read-only view of caller provided memory; never owns, grows or clears it
+  template <>
+  class block_storage< read_only_view >
+  {
+  public:
+    block_storage() noexcept = default;
+
+    block_storage( byte const *data_p, std::size_t capacity ) noexcept :
+      m_data_p( data_p ), m_capacity( capacity )
+    {
+    }
+
+    block_storage( block_storage const & ) = delete;
+
+    block_storage( block_storage &&other ) noexcept :
+      m_data_p( std::exchange( other.m_data_p, nullptr ) ),
+      m_capacity( std::exchange( other.m_capacity, 0u ) )
+    {
+    }
+
+    block_storage &operator=( block_storage const & ) = delete;
+
+    block_storage &operator=( block_storage &&other ) noexcept
+    {
+      m_data_p = std::exchange( other.m_data_p, nullptr );
+      m_capacity = std::exchange( other.m_capacity, 0u );
+      return *this;
+    }
+
+    ~block_storage() noexcept = default;
+
+    byte const *data() const noexcept { return m_data_p; }
+
+    std::size_t capacity() const noexcept { return m_capacity; }
+
+  private:
+    byte const *m_data_p = nullptr;
+    std::size_t m_capacity = 0u;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_BLOCK_STORAGE_H_INCLUDED
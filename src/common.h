@@ -2,6 +2,7 @@
 #define CODING_COMMON_H_INCLUDED
 
 #include <cstdint>
+#include <type_traits>
 
 namespace coding
 {
@@ -9,6 +10,14 @@ namespace coding
   using word = std::uint16_t;
   using uint = std::uint32_t;
   using ulong = std::uint64_t;
+
+  // storage type of numeral system values ( 0 .. 2^N ) for N-bit base
+  template < std::size_t N >
+  using num_word = std::conditional_t< ( N < 16u ), word, uint >;
+
+  // type of symbols of SL bits; byte alphabets keep byte
+  template < std::size_t SL >
+  using sym_word = std::conditional_t< ( SL <= 8u ), byte, word >;
 }  // namespace coding
 
 #endif  // !CODING_COMMON_H_INCLUDED
@@ -14,15 +14,15 @@ namespace coding
   {
   public:
     uint symbol_length() const noexcept { return static_cast< uint >( SL ); }
-    uint symbol_count() const noexcept { return m_symbol_count; }
-    uint decoded_length() const noexcept
+    ulong symbol_count() const noexcept { return m_symbol_count; }
+    ulong decoded_length() const noexcept
     {
       return symbol_length() * symbol_count();
     }
 
-    uint raw_encoded_length() const noexcept { return m_raw_bit_count; }
-    uint header_length() const noexcept { return m_header_bit_count; }
-    uint encoded_length() const noexcept
+    ulong raw_encoded_length() const noexcept { return m_raw_bit_count; }
+    ulong header_length() const noexcept { return m_header_bit_count; }
+    ulong encoded_length() const noexcept
     {
       return raw_encoded_length() + header_length();
     }
@@ -70,13 +70,13 @@ namespace coding
       return m_decoding_time_ns;
     }
 
-    void set_symbol_count( uint value ) { m_symbol_count = value; }
-    void set_raw_encoded_length( uint value ) { m_raw_bit_count = value; }
-    void set_encoded_length( uint value )
+    void set_symbol_count( ulong value ) { m_symbol_count = value; }
+    void set_raw_encoded_length( ulong value ) { m_raw_bit_count = value; }
+    void set_encoded_length( ulong value )
     {
       m_raw_bit_count = value - header_length();
     }
-    void set_header_length( uint value ) { m_header_bit_count = value; }
+    void set_header_length( ulong value ) { m_header_bit_count = value; }
     void set_bits_per_symbol_theory( double value )
     {
       m_bits_per_symbol_th = value;
@@ -94,11 +94,11 @@ namespace coding
     {
       std::printf( "ENCODER STATS FOR '%s':\n", encoder_name );
       std::printf( " - symbol length:  %12u bits\n", symbol_length() );
-      std::printf( " - symbol count:   %12u\n", symbol_count() );
-      std::printf( " - header length:  %12u bits\n\n", header_length() );
+      std::printf( " - symbol count:   %12lu\n", symbol_count() );
+      std::printf( " - header length:  %12lu bits\n\n", header_length() );
 
-      std::printf( " - decoded length: %12u bits\n", decoded_length() );
-      std::printf( " - encoded length: %12u bits    (w/o header: %u bits)\n",
+      std::printf( " - decoded length: %12lu bits\n", decoded_length() );
+      std::printf( " - encoded length: %12lu bits    (w/o header: %lu bits)\n",
                    encoded_length(), raw_encoded_length() );
       std::printf( " - compression_rate: %13.2f%%     (w/o header: %.2f%%)\n\n",
                    compression_rate() * 100.0, raw_compression_rate() * 100.0 );
@@ -115,9 +115,9 @@ namespace coding
     }
 
   private:
-    uint m_symbol_count = 0u;
-    uint m_raw_bit_count = 0u;
-    uint m_header_bit_count = 0u;
+    ulong m_symbol_count = 0u;
+    ulong m_raw_bit_count = 0u;
+    ulong m_header_bit_count = 0u;
     double m_bits_per_symbol_th = 0.0;
     std::chrono::nanoseconds m_encoding_time_ns = {};
     std::chrono::nanoseconds m_decoding_time_ns = {};
@@ -1,5 +1,202 @@
 #include "data_block.h"
 
-namespace coding
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+namespace coding::detail
 {
-}  // namespace coding
+  namespace
+  {
+    // low SL bits of every byte of 64-bit word; SL bytes of packed
+    //  symbols fill it whole
+    template < std::size_t SL >
+    constexpr ulong lane_mask = 0x0101010101010101ul * ( ( 1ul << SL ) - 1ul );
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+    // BMI2 is used when processor has it, whatever instruction set the
+    //  library is built for
+    bool has_bmi2() noexcept
+    {
+      static const bool result = __builtin_cpu_supports( "bmi2" ) != 0;
+      return result;
+    }
+
+    // whole words of SL packed bytes, returns number of bytes unpacked
+    template < std::size_t SL >
+    __attribute__( ( target( "bmi2" ) ) ) std::size_t
+    unpack_bmi2( byte const *src_p, std::size_t bytes, byte *dst_p ) noexcept
+    {
+      constexpr std::size_t per_byte = 8u / SL;
+      std::size_t i = 0u;
+      for ( ; i + SL <= bytes; i += SL )
+      {
+        ulong packed = 0u;
+        std::memcpy( &packed, src_p + i, SL );
+        auto symbols =
+          static_cast< ulong >( _pdep_u64( packed, lane_mask< SL > ) );
+        std::memcpy( dst_p + i * per_byte, &symbols, sizeof( symbols ) );
+      }
+      return i;
+    }
+
+    // whole words of SL packed bytes, returns number of bytes packed
+    template < std::size_t SL >
+    __attribute__( ( target( "bmi2" ) ) ) std::size_t
+    pack_bmi2( byte const *src_p, std::size_t bytes, byte *dst_p ) noexcept
+    {
+      constexpr std::size_t per_byte = 8u / SL;
+      std::size_t i = 0u;
+      for ( ; i + SL <= bytes; i += SL )
+      {
+        ulong symbols;
+        std::memcpy( &symbols, src_p + i * per_byte, sizeof( symbols ) );
+        auto packed =
+          static_cast< ulong >( _pext_u64( symbols, lane_mask< SL > ) );
+        std::memcpy( dst_p + i, &packed, SL );
+      }
+      return i;
+    }
+#endif
+
+    template < std::size_t SL >
+    void unpack( byte const *src_p, std::size_t bytes, byte *dst_p ) noexcept
+    {
+      constexpr std::size_t per_byte = 8u / SL;
+      std::size_t i = 0u;
+#if defined( __x86_64__ ) || defined( __i386__ )
+      if ( has_bmi2() )
+      {
+        i = unpack_bmi2< SL >( src_p, bytes, dst_p );
+      }
+#endif
+      for ( ; i < bytes; ++i )
+      {
+        for ( std::size_t k = 0u; k < per_byte; ++k )
+        {
+          dst_p[ i * per_byte + k ] = static_cast< byte >(
+            ( src_p[ i ] >> ( k * SL ) ) & ( ( 1u << SL ) - 1u ) );
+        }
+      }
+    }
+
+    template < std::size_t SL >
+    void pack( byte const *src_p, std::size_t bytes, byte *dst_p ) noexcept
+    {
+      constexpr std::size_t per_byte = 8u / SL;
+      std::size_t i = 0u;
+#if defined( __x86_64__ ) || defined( __i386__ )
+      if ( has_bmi2() )
+      {
+        i = pack_bmi2< SL >( src_p, bytes, dst_p );
+      }
+#endif
+      for ( ; i < bytes; ++i )
+      {
+        uint packed = 0u;
+        for ( std::size_t k = 0u; k < per_byte; ++k )
+        {
+          packed |= ( src_p[ i * per_byte + k ] & ( ( 1u << SL ) - 1u ) )
+                    << ( k * SL );
+        }
+        dst_p[ i ] = static_cast< byte >( packed );
+      }
+    }
+  }  // namespace
+
+  void unpack_symbols( byte const *src_p, std::size_t bytes,
+                       std::size_t symbol_length, byte *dst_p ) noexcept
+  {
+    switch ( symbol_length )
+    {
+    case 1u:
+      unpack< 1 >( src_p, bytes, dst_p );
+      break;
+    case 2u:
+      unpack< 2 >( src_p, bytes, dst_p );
+      break;
+    case 4u:
+      unpack< 4 >( src_p, bytes, dst_p );
+      break;
+    default:
+      std::memcpy( dst_p, src_p, bytes );
+      break;
+    }
+  }
+
+  void pack_symbols( byte const *src_p, std::size_t bytes,
+                     std::size_t symbol_length, byte *dst_p ) noexcept
+  {
+    switch ( symbol_length )
+    {
+    case 1u:
+      pack< 1 >( src_p, bytes, dst_p );
+      break;
+    case 2u:
+      pack< 2 >( src_p, bytes, dst_p );
+      break;
+    case 4u:
+      pack< 4 >( src_p, bytes, dst_p );
+      break;
+    default:
+      std::memcpy( dst_p, src_p, bytes );
+      break;
+    }
+  }
+
+  input_file::input_file( char const *filepath ) :
+    m_filepath( filepath ), m_fd( ::open( filepath, O_RDONLY ) )
+  {
+    if ( m_fd < 0 )
+    {
+      throw std::system_error( errno, std::generic_category(), filepath );
+    }
+
+    struct stat st;
+    auto err = ::fstat( m_fd, &st ) != 0 ? errno : 0;
+    if ( err == 0 && S_ISDIR( st.st_mode ) )
+    {
+      err = EISDIR;
+    }
+    if ( err != 0 )
+    {
+      ::close( m_fd );
+      throw std::system_error( err, std::generic_category(), filepath );
+    }
+
+    m_regular = S_ISREG( st.st_mode );
+    m_size = m_regular ? static_cast< std::size_t >( st.st_size ) : 0u;
+  }
+
+  input_file::~input_file() noexcept { ::close( m_fd ); }
+
+  std::size_t input_file::read( byte *dst_p, std::size_t n )
+  {
+    std::size_t total = 0u;
+    while ( total < n )
+    {
+      auto r = ::read( m_fd, dst_p + total, n - total );
+      if ( r == 0 )
+      {
+        break;
+      }
+      if ( r < 0 )
+      {
+        if ( errno == EINTR )
+        {
+          continue;
+        }
+        throw std::system_error( errno, std::generic_category(), m_filepath );
+      }
+      total += static_cast< std::size_t >( r );
+    }
+    return total;
+  }
+
+}  // namespace coding::detail
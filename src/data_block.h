@@ -3,27 +3,135 @@
 
 #include <cstdio>
 #include <cstring>
-#include <fstream>
 #include <iterator>
+#include <system_error>
 #include <utility>
 
+#include "block_storage.h"
 #include "common.h"
 
 namespace coding
 {
-  // binary symbol buffer of fixed maximal size with non-parallelizable
-  //  sequential access
-  // supported symbol lengths: 1, 2, 4, 8
+  namespace detail
+  {
+    // spreads symbols of given length ( 1, 2, 4 or 8 bits ) packed in bytes
+    //  of src_p, lowest bits first, to one symbol per byte of dst_p
+    void unpack_symbols( byte const *src_p, std::size_t bytes,
+                         std::size_t symbol_length, byte *dst_p ) noexcept;
+
+    // inverse of unpack_symbols; bytes of packed symbols are stored whole
+    void pack_symbols( byte const *src_p, std::size_t bytes,
+                       std::size_t symbol_length, byte *dst_p ) noexcept;
+
+    // file opened for reading, closed on destruction; failures are reported
+    //  with std::system_error carrying errno
+    class input_file
+    {
+    public:
+      explicit input_file( char const *filepath );
+      input_file( input_file const & ) = delete;
+      input_file &operator=( input_file const & ) = delete;
+      ~input_file() noexcept;
+
+      // size is known up front only for regular files ( not e.g. pipes )
+      bool is_regular() const noexcept { return m_regular; }
+
+      std::size_t size() const noexcept { return m_size; }
+
+      // reads up to n bytes; fewer are read only at end of file
+      std::size_t read( byte *dst_p, std::size_t n );
+
+    private:
+      char const *m_filepath;
+      int m_fd = -1;
+      bool m_regular = false;
+      std::size_t m_size = 0u;
+    };
+  }  // namespace detail
+
+  // symbols moved at once between data block and unpacked span by coders
+  constexpr std::size_t unpacked_span_size = 1024u;
+
+  // initial capacity of runtime-sized block loaded from input of unknown size
+  constexpr std::size_t load_chunk_size = 64u << 10u;
+
+  // binary symbol buffer with non-parallelizable sequential access; of fixed
+  //  maximal size N or runtime-sized ( growing on write ) for
+  //  N == dynamic_size; for N == read_only_view it only reads external memory
+  //  and all writing members fail to compile
+  // supported symbol lengths: 1 .. 16; symbols of 1, 2, 4 and 8 bits never
+  //  cross byte boundary, longer or unaligned ones span up to 3 bytes
   template < std::size_t N, std::size_t SL >
   class data_block
   {
   public:
-    data_block() noexcept { reset(); }
+    static_assert( SL >= 1u && SL <= 16u, "unsupported symbol length" );
+
+    using symbol_type = sym_word< SL >;
+
+  private:
+    static constexpr bool read_only = N == read_only_view;
+
+  public:
+    using pointer = std::conditional_t< read_only, byte const *, byte * >;
+
+    data_block() noexcept
+    {
+      if constexpr ( read_only )
+      {
+        m_curr_p = m_storage.data();
+        m_end_p = m_storage.data();
+      }
+      else
+      {
+        reset();
+      }
+    }
+
     explicit data_block( char const *filepath ) { load( filepath ); }
+
+    explicit data_block( std::size_t capacity ) : m_storage( capacity )
+    {
+      static_assert( N == dynamic_size, "capacity given for fixed size" );
+      reset();
+    }
+
+    // view of size bytes of symbols in external memory
+    data_block( byte *data_p, std::size_t size ) noexcept :
+      m_storage( data_p, size ),
+      m_curr_p( m_storage.data() ),
+      m_end_p( m_storage.data() + size )
+    {
+      static_assert( N == dynamic_size || read_only,
+                     "external memory for fixed size" );
+    }
+
+    // read-only view ( e.g. of mapped file )
+    data_block( byte const *data_p, std::size_t size ) noexcept :
+      m_storage( data_p, size ),
+      m_curr_p( m_storage.data() ),
+      m_end_p( m_storage.data() + size )
+    {
+      static_assert( read_only, "read-only memory for writable block" );
+    }
+
     data_block( data_block const & ) = delete;
-    data_block( data_block && ) = delete;
+    data_block( data_block &&other ) noexcept { *this = std::move( other ); }
     data_block &operator=( data_block const & ) = delete;
-    data_block &operator=( data_block && ) = delete;
+
+    data_block &operator=( data_block &&other ) noexcept
+    {
+      auto curr = other.offset();
+      auto end = other.raw_byte_count();
+      m_storage = std::move( other.m_storage );
+      m_curr_p = m_storage.data() + curr;
+      m_end_p = m_storage.data() + end;
+      m_bit_offset = std::exchange( other.m_bit_offset, 0u );
+      other.m_curr_p = other.m_storage.data();
+      other.m_end_p = other.m_storage.data();
+      return *this;
+    }
+
     ~data_block() noexcept = default;
 
     std::size_t size() const noexcept
@@ -31,14 +139,22 @@ namespace coding
       return raw_byte_count() + ( ( m_bit_offset == 0 ) ? 0 : 1 );
     }
 
-    std::size_t max_size() const noexcept { return N; }
+    std::size_t max_size() const noexcept { return m_storage.capacity(); }
+
+    // whole bytes of symbols, without byte being written
+    std::size_t raw_byte_count() const noexcept
+    {
+      return static_cast< std::size_t >(
+        reinterpret_cast< std::uintptr_t >( m_end_p ) -
+        reinterpret_cast< std::uintptr_t >( m_storage.data() ) );
+    }
 
     std::size_t bit_count() const noexcept
     {
       return ( raw_byte_count() << 3u ) + m_bit_offset;
     }
 
-    std::size_t max_bit_count() const noexcept { return N << 3u; }
+    std::size_t max_bit_count() const noexcept { return max_size() << 3u; }
 
     std::size_t symbol_count() const noexcept { return bit_count() / SL; }
 
@@ -49,92 +165,275 @@ namespace coding
 
     std::size_t symbol_length() const noexcept { return SL; }
 
+    // symbols read by read_symbol() from cursor until block is false
+    std::size_t symbols_left() const noexcept
+    {
+      auto pos = ( offset() << 3u ) + m_bit_offset;
+      auto end = raw_byte_count() << 3u;
+      return pos < end ? ( end - pos + SL - 1u ) / SL : 0u;
+    }
+
+    pointer data() noexcept { return m_storage.data(); }
+
+    byte const *data() const noexcept { return m_storage.data(); }
+
     operator bool() const noexcept { return m_curr_p != m_end_p; }
 
     bool is_beg() const noexcept
     {
-      return m_curr_p == m_data_p && m_bit_offset == 0u;
+      return m_curr_p == m_storage.data() && m_bit_offset == 0u;
+    }
+
+    // ensures room for n bytes in total; fails only for fixed size
+    bool reserve( std::size_t n )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      auto curr = offset();
+      auto end = raw_byte_count();
+      if ( !m_storage.reserve( n ) )
+      {
+        return false;
+      }
+      m_curr_p = m_storage.data() + curr;
+      m_end_p = m_storage.data() + end;
+      return true;
     }
 
     void prepare_full()
     {
-      m_end_p = m_data_p;
+      static_assert( !read_only, "read-only view cannot be written" );
+      m_end_p = m_storage.data();
       std::advance( m_end_p, max_size() );
       m_curr_p = m_end_p;
     }
 
-    void write_symbol( byte symbol )
+    // prepares cleared block for reverse writing of given number of symbols;
+    //  fails if they do not fit in block of fixed size
+    bool prepare( std::size_t symbol_count )
     {
-      symbol = static_cast< byte >(
-        ( ( symbol & mask() ) << static_cast< byte >( m_bit_offset ) ) );
-      *m_curr_p |= symbol;
+      static_assert( !read_only, "read-only view cannot be written" );
+      auto bits = symbol_count * SL;
+      auto bytes = ( bits + 7u ) >> 3u;
+      if ( !reserve( bytes ) )
+      {
+        return false;
+      }
+      std::memset( static_cast< void * >( m_storage.data() ), 0, bytes );
+      m_end_p = m_storage.data();
+      std::advance( m_end_p, bytes );
+      m_curr_p = m_storage.data();
+      std::advance( m_curr_p, bits >> 3u );
+      m_bit_offset = bits & 7u;
+      return true;
+    }
+
+    void write_symbol( symbol_type symbol )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      if constexpr ( N == dynamic_size )
+      {
+        if ( offset() + symbol_span() > max_size() )
+        {
+          reserve( offset() + symbol_span() );
+        }
+      }
+      put_symbol( symbol );
       advance_symbol_length();
       m_end_p = m_curr_p;
     }
 
-    void write_symbol_reverse( byte symbol )
+    void write_symbol_reverse( symbol_type symbol )
     {
+      static_assert( !read_only, "read-only view cannot be written" );
       reverse_symbol_length();
-      symbol = static_cast< byte >(
-        ( ( symbol & mask() ) << static_cast< byte >( m_bit_offset ) ) );
-      *m_curr_p |= symbol;
+      put_symbol( symbol );
     }
 
-    byte read_symbol() noexcept
+    symbol_type read_symbol() noexcept
     {
-      auto result = static_cast< byte >(
-        static_cast< byte >( ( *m_curr_p ) >> m_bit_offset ) & mask() );
+      auto result = get_symbol();
       advance_symbol_length();
       return result;
     }
 
+    symbol_type read_symbol_reverse() noexcept
+    {
+      reverse_symbol_length();
+      return get_symbol();
+    }
+
+    // bulk counterparts of the above move count symbols between cursor and
+    //  unpacked span symbols_p, kept in block order in both directions;
+    //  whole bytes of 1, 2, 4 and 8-bit symbols are ( un )packed at once
+    // as with single symbols, reading past either end is not checked
+
+    void write_symbols( symbol_type const *symbols_p, std::size_t count )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      if constexpr ( N == dynamic_size )
+      {
+        auto bytes = offset() + ( ( m_bit_offset + count * SL + 7u ) >> 3u );
+        if ( bytes > max_size() )
+        {
+          reserve( bytes );
+        }
+      }
+      std::size_t i = 0u;
+      if constexpr ( byte_aligned )
+      {
+        for ( ; i < count && m_bit_offset != 0u; ++i )
+        {
+          write_symbol( symbols_p[ i ] );
+        }
+        auto bytes = ( count - i ) / per_byte;
+        detail::pack_symbols( symbols_p + i, bytes, SL, m_curr_p );
+        std::advance( m_curr_p, bytes );
+        m_end_p = m_curr_p;
+        i += bytes * per_byte;
+      }
+      for ( ; i < count; ++i )
+      {
+        write_symbol( symbols_p[ i ] );
+      }
+    }
+
+    void write_symbols_reverse( symbol_type const *symbols_p,
+                                std::size_t count )
+    {
+      static_assert( !read_only, "read-only view cannot be written" );
+      auto i = count;
+      if constexpr ( byte_aligned )
+      {
+        for ( ; i > 0u && m_bit_offset != 0u; --i )
+        {
+          write_symbol_reverse( symbols_p[ i - 1u ] );
+        }
+        auto bytes = i / per_byte;
+        i -= bytes * per_byte;
+        std::advance( m_curr_p, -static_cast< std::ptrdiff_t >( bytes ) );
+        detail::pack_symbols( symbols_p + i, bytes, SL, m_curr_p );
+      }
+      for ( ; i > 0u; --i )
+      {
+        write_symbol_reverse( symbols_p[ i - 1u ] );
+      }
+    }
+
+    void read_symbols( symbol_type *symbols_p, std::size_t count ) noexcept
+    {
+      std::size_t i = 0u;
+      if constexpr ( byte_aligned )
+      {
+        for ( ; i < count && m_bit_offset != 0u; ++i )
+        {
+          symbols_p[ i ] = read_symbol();
+        }
+        auto bytes = ( count - i ) / per_byte;
+        detail::unpack_symbols( m_curr_p, bytes, SL, symbols_p + i );
+        std::advance( m_curr_p, bytes );
+        i += bytes * per_byte;
+      }
+      for ( ; i < count; ++i )
+      {
+        symbols_p[ i ] = read_symbol();
+      }
+    }
+
+    void read_symbols_reverse( symbol_type *symbols_p,
+                               std::size_t count ) noexcept
+    {
+      auto i = count;
+      if constexpr ( byte_aligned )
+      {
+        for ( ; i > 0u && m_bit_offset != 0u; --i )
+        {
+          symbols_p[ i - 1u ] = read_symbol_reverse();
+        }
+        auto bytes = i / per_byte;
+        i -= bytes * per_byte;
+        std::advance( m_curr_p, -static_cast< std::ptrdiff_t >( bytes ) );
+        detail::unpack_symbols( m_curr_p, bytes, SL, symbols_p + i );
+      }
+      for ( ; i > 0u; --i )
+      {
+        symbols_p[ i - 1u ] = read_symbol_reverse();
+      }
+    }
+
+    // moves cursor past last symbol for reverse reading
+    void fast_forward() noexcept
+    {
+      auto bits = symbol_count() * SL;
+      m_curr_p = m_storage.data();
+      std::advance( m_curr_p, bits >> 3u );
+      m_bit_offset = bits & 7u;
+    }
+
     void reset() noexcept
     {
-      std::memset( static_cast< void * >( m_data_p ), 0, N );
-      m_curr_p = m_data_p;
-      m_end_p = m_data_p;
+      static_assert( !read_only, "read-only view cannot be written" );
+      m_storage.clear();
+      m_curr_p = m_storage.data();
+      m_end_p = m_storage.data();
       m_bit_offset = 0;
     }
 
-    void load( char const *filepath )
+    // loads file contents; block of fixed size keeps only first N bytes
+    //  and false is returned if file was truncated; runtime-sized block is
+    //  sized up front for regular files and grows while reading other inputs
+    //  ( e.g. pipes )
+    bool load( char const *filepath )
     {
+      static_assert( !read_only, "read-only view cannot be written" );
       reset();
 
-      auto fin = std::ifstream( filepath, std::ios::binary );
-      if ( !fin.is_open() )
+      auto file = detail::input_file( filepath );
+      if constexpr ( N == dynamic_size )
       {
-        std::printf( "Failed to load data from file: '%s'.", filepath );
+        reserve( file.is_regular() ? file.size() : load_chunk_size );
       }
 
-      auto bytes_read =
-        fin.readsome( reinterpret_cast< char * >( m_data_p ), N );
-      std::advance( m_end_p, bytes_read );
-
-      fin.close();
+      byte next = 0u;
+      for ( ;; )
+      {
+        auto room = max_size() - raw_byte_count();
+        auto n = file.read( m_end_p, room );
+        std::advance( m_end_p, n );
+        if ( n < room || file.read( &next, 1u ) == 0u )
+        {
+          return true;
+        }
+        if constexpr ( N != dynamic_size )
+        {
+          return false;
+        }
+        reserve( max_size() + 1u );
+        *m_end_p = next;
+        std::advance( m_end_p, 1 );
+      }
     }
 
     void rewind() noexcept
     {
-      m_curr_p = m_data_p;
+      m_curr_p = m_storage.data();
       m_bit_offset = 0;
     }
 
     std::pair< std::size_t, std::size_t > get_position() const noexcept
     {
-      return std::make_pair( static_cast< std::size_t >(
-                               reinterpret_cast< std::uintptr_t >( m_end_p ) -
-                               reinterpret_cast< std::uintptr_t >( m_data_p ) ),
-                             m_bit_offset );
+      return std::make_pair( offset(), m_bit_offset );
     }
 
-    void set_position( std::pair< std::size_t, std::size_t > &pos ) noexcept
+    void
+    set_position( std::pair< std::size_t, std::size_t > const &pos ) noexcept
     {
       rewind();
       std::advance( m_curr_p, pos.first );
       m_bit_offset = pos.second;
     }
 
-    bool operator==( data_block const &other ) const noexcept
+    template < std::size_t _OtherSize >
+    bool operator==( data_block< _OtherSize, SL > const &other ) const noexcept
     {
       if ( size() != other.size() )
       {
@@ -143,7 +442,7 @@ namespace coding
 
       for ( std::size_t i = 0; i < size(); ++i )
       {
-        if ( m_data_p[ i ] != other.m_data_p[ i ] )
+        if ( m_storage.data()[ i ] != other.data()[ i ] )
         {
           return false;
         }
@@ -152,7 +451,8 @@ namespace coding
       return true;
     }
 
-    bool operator!=( data_block const &other ) const noexcept
+    template < std::size_t _OtherSize >
+    bool operator!=( data_block< _OtherSize, SL > const &other ) const noexcept
     {
       return !( *this == other );
     }
@@ -161,45 +461,106 @@ namespace coding
     {
       for ( size_t i = 0u; i < size(); ++i )
       {
-        std::printf( "%c", m_data_p[ i ] );
+        std::printf( "%c", m_storage.data()[ i ] );
       }
     }
 
   private:
+    static constexpr bool byte_aligned = 8u % SL == 0u;
+    static constexpr std::size_t per_byte = byte_aligned ? 8u / SL : 0u;
+
     void advance_symbol_length()
     {
-      m_bit_offset = ( m_bit_offset + SL ) % 8u;
-      if ( m_bit_offset == 0u )
+      if constexpr ( byte_aligned )
+      {
+        m_bit_offset = ( m_bit_offset + SL ) % 8u;
+        if ( m_bit_offset == 0u )
+        {
+          std::advance( m_curr_p, 1 );
+        }
+      }
+      else
       {
-        std::advance( m_curr_p, 1 );
+        auto bits = m_bit_offset + SL;
+        std::advance( m_curr_p, bits >> 3u );
+        m_bit_offset = bits & 7u;
       }
     }
 
     void reverse_symbol_length()
     {
-      if ( m_bit_offset == 0u )
+      if constexpr ( byte_aligned )
       {
-        std::advance( m_curr_p, -1 );
+        if ( m_bit_offset == 0u )
+        {
+          std::advance( m_curr_p, -1 );
+        }
+      }
+      else
+      {
+        auto back = ( SL + 7u - m_bit_offset ) >> 3u;
+        std::advance( m_curr_p, -static_cast< std::ptrdiff_t >( back ) );
       }
       m_bit_offset = ( m_bit_offset - SL ) % 8u;
     }
 
-    byte mask() const noexcept
+    // bytes touched by symbol at cursor
+    std::size_t symbol_span() const noexcept
     {
-      return ( byte{ 1 } << static_cast< byte >( SL ) ) - byte{ 1 };
+      return byte_aligned ? 1u : ( m_bit_offset + SL + 7u ) >> 3u;
     }
 
-    std::size_t raw_byte_count() const noexcept
+    void put_symbol( symbol_type symbol ) noexcept
+    {
+      if constexpr ( byte_aligned )
+      {
+        *m_curr_p |= static_cast< byte >(
+          ( symbol & mask() ) << static_cast< byte >( m_bit_offset ) );
+      }
+      else
+      {
+        auto bits = static_cast< uint >( symbol & mask() ) << m_bit_offset;
+        for ( std::size_t i = 0u; i < symbol_span(); ++i )
+        {
+          m_curr_p[ i ] |= static_cast< byte >( bits >> ( i << 3u ) );
+        }
+      }
+    }
+
+    symbol_type get_symbol() const noexcept
+    {
+      if constexpr ( byte_aligned )
+      {
+        return static_cast< byte >(
+          static_cast< byte >( ( *m_curr_p ) >> m_bit_offset ) & mask() );
+      }
+      else
+      {
+        uint bits = 0u;
+        for ( std::size_t i = 0u; i < symbol_span(); ++i )
+        {
+          bits |= static_cast< uint >( m_curr_p[ i ] ) << ( i << 3u );
+        }
+        return static_cast< symbol_type >( ( bits >> m_bit_offset ) & mask() );
+      }
+    }
+
+    static constexpr symbol_type mask() noexcept
+    {
+      return static_cast< symbol_type >( ( 1u << SL ) - 1u );
+    }
+
+    std::size_t offset() const noexcept
     {
       return static_cast< std::size_t >(
-        reinterpret_cast< std::uintptr_t >( m_end_p ) -
-        reinterpret_cast< std::uintptr_t >( m_data_p ) );
+        reinterpret_cast< std::uintptr_t >( m_curr_p ) -
+        reinterpret_cast< std::uintptr_t >( m_storage.data() ) );
     }
 
   private:
-    byte m_data_p[ N ];
-    byte *m_curr_p;
-    byte *m_end_p;
+    block_storage< N > m_storage;
+    pointer m_curr_p;
+    pointer m_end_p;
     std::size_t m_bit_offset = 0;
   };
 
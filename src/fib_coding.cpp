@@ -0,0 +1,58 @@
+#include "fib_coding.h"
+
+namespace coding::fib
+{
+  namespace
+  {
+    struct number_table
+    {
+      constexpr number_table() noexcept : numbers_p()
+      {
+        numbers_p[ 0 ] = 1u;
+        numbers_p[ 1 ] = 2u;
+        for ( std::size_t i = 2u; i < max_length; ++i )
+        {
+          numbers_p[ i ] = numbers_p[ i - 1u ] + numbers_p[ i - 2u ];
+        }
+      }
+
+      ulong numbers_p[ max_length ];
+    };
+
+    constexpr auto numbers = number_table{};
+  }  // namespace
+
+  ulong number( std::size_t index ) noexcept
+  {
+    return numbers.numbers_p[ index ];
+  }
+
+  zeckendorf encode( ulong value ) noexcept
+  {
+    // greedy choice of largest numbers never selects two adjacent ones
+    auto result = zeckendorf{};
+    for ( std::size_t i = max_length; i > 0u && value > 0u; --i )
+    {
+      if ( numbers.numbers_p[ i - 1u ] <= value )
+      {
+        result.set( i - 1u );
+        value -= numbers.numbers_p[ i - 1u ];
+      }
+    }
+    return result;
+  }
+
+  ulong decode( zeckendorf const &bits ) noexcept
+  {
+    ulong result = 0u;
+    for ( std::size_t i = 0u; i < max_length; ++i )
+    {
+      if ( bits[ i ] )
+      {
+        result += numbers.numbers_p[ i ];
+      }
+    }
+    return result;
+  }
+
+}  // namespace coding::fib
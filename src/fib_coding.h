@@ -0,0 +1,73 @@
+#ifndef CODING_FIB_CODING_H_INCLUDED
+#define CODING_FIB_CODING_H_INCLUDED
+
+#include <bitset>
+#include <stdexcept>
+
+#include "common.h"
+
+namespace coding::fib
+{
+  // number of Fibonacci numbers F(2) .. F(93) representable in 64 bits
+  constexpr std::size_t max_length = 92u;
+
+  // Zeckendorf representation of value; bit i stands for F(i + 2)
+  using zeckendorf = std::bitset< max_length >;
+
+  // Fibonacci number F(i + 2), weight of i-th bit
+  ulong number( std::size_t index ) noexcept;
+
+  zeckendorf encode( ulong value ) noexcept;
+
+  ulong decode( zeckendorf const &bits ) noexcept;
+
+  // writes Fibonacci code of value >= 1 ( Zeckendorf bits from least
+  //  significant one, terminated by additional 1 ) using write_bit( bool )
+  template < typename _BitWriter >
+  void write_code( _BitWriter &writer, ulong value )
+  {
+    auto bits = encode( value );
+    std::size_t length = max_length;
+    while ( length > 0u && !bits[ length - 1u ] )
+    {
+      --length;
+    }
+    for ( std::size_t i = 0u; i < length; ++i )
+    {
+      writer.write_bit( bits[ i ] );
+    }
+    writer.write_bit( true );
+  }
+
+  // reads Fibonacci code written by write_code using read_bit(); throws
+  //  std::invalid_argument if terminator is missing after max_length bits
+  template < typename _BitReader >
+  ulong read_code( _BitReader &reader )
+  {
+    ulong value = 0u;
+    auto prev = false;
+    for ( std::size_t i = 0u; i < max_length; ++i )
+    {
+      auto bit = reader.read_bit();
+      if ( bit && prev )
+      {
+        return value;
+      }
+      if ( bit )
+      {
+        value += number( i );
+      }
+      prev = bit;
+    }
+
+    // longest code ends with its highest bit followed by terminator
+    if ( !prev || !reader.read_bit() )
+    {
+      throw std::invalid_argument( "Fibonacci code without terminator" );
+    }
+    return value;
+  }
+
+}  // namespace coding::fib
+
+#endif  // !CODING_FIB_CODING_H_INCLUDED
@@ -0,0 +1,112 @@
+#include "freq_normalize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace coding
+{
+  namespace
+  {
+    // change of coded size ( in bits ) when frequency of symbol with given
+    //  count goes from f to f + 1
+    double step_gain( uint count, ulong f ) noexcept
+    {
+      return static_cast< double >( count ) *
+             std::log2( static_cast< double >( f + 1u ) /
+                        static_cast< double >( f ) );
+    }
+  }  // namespace
+
+  void normalize_freqs( uint *freqs_p, std::size_t size, uint target )
+  {
+    auto scratch = normalize_scratch{};
+    normalize_freqs( freqs_p, size, target, scratch );
+  }
+
+  void normalize_freqs( uint *freqs_p, std::size_t size, uint target,
+                        normalize_scratch &scratch )
+  {
+    ulong total = 0u;
+    std::size_t present = 0u;
+    for ( std::size_t i = 0u; i < size; ++i )
+    {
+      total += freqs_p[ i ];
+      present += freqs_p[ i ] != 0u ? 1u : 0u;
+    }
+    if ( total == 0u )
+    {
+      return;
+    }
+    if ( present > target )
+    {
+      throw std::invalid_argument( "more symbols present than numeral base" );
+    }
+
+    // rounded down scaled counts, raised to 1 for rare symbols
+    auto &counts = scratch.m_counts;
+    counts.assign( freqs_p, freqs_p + size );
+    auto slack = static_cast< long >( target );
+    for ( std::size_t i = 0u; i < size; ++i )
+    {
+      if ( counts[ i ] != 0u )
+      {
+        freqs_p[ i ] = static_cast< uint >( std::max< ulong >(
+          1u, static_cast< ulong >( counts[ i ] ) * target / total ) );
+        slack -= static_cast< long >( freqs_p[ i ] );
+      }
+    }
+
+    // cross-entropy is convex in every frequency, so unit steps taken
+    //  greedily ( best gain or least loss first ) reach the optimum; steps
+    //  are kept in max-heap
+    auto &steps = scratch.m_steps;
+    steps.clear();
+    auto push = [ &steps ]( double gain, std::size_t i ) {
+      steps.emplace_back( gain, i );
+      std::push_heap( steps.begin(), steps.end() );
+    };
+    auto pop = [ &steps ]() {
+      std::pop_heap( steps.begin(), steps.end() );
+      auto i = steps.back().second;
+      steps.pop_back();
+      return i;
+    };
+    if ( slack > 0 )
+    {
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        if ( counts[ i ] != 0u )
+        {
+          push( step_gain( counts[ i ], freqs_p[ i ] ), i );
+        }
+      }
+      for ( ; slack > 0; --slack )
+      {
+        auto i = pop();
+        ++freqs_p[ i ];
+        push( step_gain( counts[ i ], freqs_p[ i ] ), i );
+      }
+    }
+    else if ( slack < 0 )
+    {
+      // sum exceeds target >= present, so some frequency is above 1
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        if ( freqs_p[ i ] > 1u )
+        {
+          push( -step_gain( counts[ i ], freqs_p[ i ] - 1u ), i );
+        }
+      }
+      for ( ; slack < 0; ++slack )
+      {
+        auto i = pop();
+        --freqs_p[ i ];
+        if ( freqs_p[ i ] > 1u )
+        {
+          push( -step_gain( counts[ i ], freqs_p[ i ] - 1u ), i );
+        }
+      }
+    }
+  }
+}  // namespace coding
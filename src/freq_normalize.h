@@ -0,0 +1,44 @@
+#ifndef CODING_FREQ_NORMALIZE_H_INCLUDED
+#define CODING_FREQ_NORMALIZE_H_INCLUDED
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+namespace coding
+{
+  // working memory of normalize_freqs, kept by caller normalizing table of
+  //  every block ( cf. rans::codec_context ); reserved for alphabet size it
+  //  is not reallocated
+  class normalize_scratch
+  {
+  public:
+    normalize_scratch() = default;
+
+    explicit normalize_scratch( std::size_t size )
+    {
+      m_counts.reserve( size );
+      m_steps.reserve( size );
+    }
+
+  private:
+    friend void normalize_freqs( uint *freqs_p, std::size_t size, uint target,
+                                 normalize_scratch &scratch );
+
+    std::vector< uint > m_counts;
+    std::vector< std::pair< double, std::size_t > > m_steps;
+  };
+
+  // replaces symbol counts with frequencies summing exactly to target; every
+  //  present symbol keeps frequency of at least 1 and rounding slack goes
+  //  where it increases coded size the least ( O(size log size) );
+  //  throws std::invalid_argument if more symbols are present than target
+  void normalize_freqs( uint *freqs_p, std::size_t size, uint target );
+
+  void normalize_freqs( uint *freqs_p, std::size_t size, uint target,
+                        normalize_scratch &scratch );
+}  // namespace coding
+
+#endif  // !CODING_FREQ_NORMALIZE_H_INCLUDED
@@ -7,6 +7,8 @@
 
 #include "bit_buffer.h"
 #include "data_block.h"
+#include "header_codec.h"
+#include "histogram.h"
 
 namespace coding
 {
@@ -24,7 +26,12 @@ namespace coding
     template < std::size_t N >
     explicit freq_table( bit_buffer< N > &buf )
     {
-      buf.read( ( size() + 1 ) * sizeof( uint ), m_freqs_p );
+      read_header_freqs( buf, m_freqs_p, size(), 0u );
+      m_freqs_p[ size() ] = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        m_freqs_p[ size() ] += m_freqs_p[ i ];
+      }
       init();
     }
 
@@ -32,15 +39,8 @@ namespace coding
     explicit freq_table( data_block< N, SL > &data )
     {
       std::memset( m_freqs_p, 0, ( size() ) * sizeof( uint ) );
-      uint count = 0u;
-      auto cursor_pos = data.get_position();
-      while ( data )
-      {
-        ++m_freqs_p[ data.read_symbol() ];
-        count++;
-      }
-      data.set_position( cursor_pos );
-      m_freqs_p[ size() ] = count;
+      m_freqs_p[ size() ] =
+        static_cast< uint >( count_symbols( data, m_freqs_p ) );
       init();
     }
 
@@ -48,9 +48,11 @@ namespace coding
 
     std::size_t size() const noexcept { return 1u << SL; }
 
-    uint header_length() const noexcept
+    uint header_length( header_format format = default_header_format ) const
     {
-      return ( static_cast< uint >( ( size() ) + 1u ) * sizeof( uint ) ) << 3u;
+      return static_cast< uint >(
+               header_freqs_size( m_freqs_p, size(), 0u, format ) )
+             << 3u;
     }
 
     uint freq( std::size_t index ) const noexcept { return m_freqs_p[ index ]; }
@@ -79,7 +81,7 @@ namespace coding
       return result;
     }
 
-    byte symbol( double value ) const noexcept
+    sym_word< SL > symbol( double value ) const noexcept
     {
       // simple linear search
       std::size_t i = 0u;
@@ -91,7 +93,7 @@ namespace coding
         }
         ++i;
       }
-      return static_cast< byte >( i - 1u );
+      return static_cast< sym_word< SL > >( i - 1u );
     }
 
     void display()
@@ -105,10 +107,27 @@ namespace coding
       }
     }
 
+    // reads header ending at cursor and moves cursor to its beginning
+    template < std::size_t N >
+    static freq_table read_header_reverse( bit_buffer< N > &buf )
+    {
+      auto result = freq_table();
+      read_header_freqs_reverse( buf, result.m_freqs_p, result.size(), 0u );
+      result.m_freqs_p[ result.size() ] = 0u;
+      for ( std::size_t i = 0u; i < result.size(); ++i )
+      {
+        result.m_freqs_p[ result.size() ] += result.m_freqs_p[ i ];
+      }
+      result.init();
+      return result;
+    }
+
+    // total count is restored from frequencies
     template < std::size_t N >
-    void write_header( bit_buffer< N > &buf ) noexcept
+    void write_header( bit_buffer< N > &buf,
+                       header_format format = default_header_format ) const
     {
-      buf.write( ( size() + 1 ) * sizeof( uint ), m_freqs_p );
+      write_header_freqs( buf, m_freqs_p, size(), 0u, format );
     }
 
     bool operator==( freq_table const &other ) const noexcept
@@ -0,0 +1,5 @@
+#include "header_codec.h"
+
+namespace coding
+{
+}  // namespace coding
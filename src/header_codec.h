@@ -0,0 +1,636 @@
+#ifndef CODING_HEADER_CODEC_H_INCLUDED
+#define CODING_HEADER_CODEC_H_INCLUDED
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "common.h"
+#include "fib_coding.h"
+
+namespace coding
+{
+  // encoding of symbol frequencies in frequency table headers
+  enum class header_format : byte
+  {
+    raw = 0u,        // all frequencies as stored
+    varint = 1u,     // present symbols, frequencies in 7-bit groups
+    fibonacci = 2u,  // present symbols, Fibonacci coded frequencies
+  };
+
+  constexpr header_format default_header_format = header_format::varint;
+
+  // header layout (readable both forward and back to front):
+  //  [format][payload][payload length]
+  // payload length is written in 7-bit groups from the end; compact payloads
+  // list present symbols ( as bitmap, or as coded gaps between them for
+  // sparse tables ) followed by their frequencies minus one, frequency of
+  // last present symbol is omitted when total is known
+  //
+  // streams written before this layout carry legacy header instead, raw dump
+  // of C(S) as 16-bit words with neither format nor length; it cannot be told
+  // apart from tagged header, such streams are decoded by rans::decode_legacy
+
+  namespace detail
+  {
+    // format byte flag of symbol list given by gaps instead of bitmap
+    constexpr byte header_gaps_flag = 0x10u;
+    constexpr byte header_format_mask = 0x0fu;
+
+    // bit stream packed from least significant bit of each byte
+    class header_writer
+    {
+    public:
+      void write_bit( bool bit )
+      {
+        if ( ( m_bit_count & 7u ) == 0u )
+        {
+          m_bytes.push_back( 0u );
+        }
+        if ( bit )
+        {
+          m_bytes.back() |= static_cast< byte >( 1u << ( m_bit_count & 7u ) );
+        }
+        ++m_bit_count;
+      }
+
+      void write_bits( ulong value, std::size_t n )
+      {
+        for ( std::size_t i = 0u; i < n; ++i )
+        {
+          write_bit( ( ( value >> i ) & 1u ) != 0u );
+        }
+      }
+
+      void write_value( header_format format, ulong value )
+      {
+        if ( format == header_format::fibonacci )
+        {
+          fib::write_code( *this, value + 1u );
+          return;
+        }
+        do
+        {
+          auto group = value & 0x7fu;
+          value >>= 7u;
+          write_bits( group | ( value != 0u ? 0x80u : 0u ), 8u );
+        } while ( value != 0u );
+      }
+
+      std::vector< byte > const &bytes() const noexcept { return m_bytes; }
+
+      // empties writer, allocated bytes are kept for next header
+      void clear() noexcept
+      {
+        m_bytes.clear();
+        m_bit_count = 0u;
+      }
+
+    private:
+      std::vector< byte > m_bytes;
+      std::size_t m_bit_count = 0u;
+    };
+
+    // counterpart of header_writer only measuring payload, so that header
+    //  length is known without writing header
+    class header_counter
+    {
+    public:
+      void write_bit( [[maybe_unused]] bool bit ) noexcept { ++m_bit_count; }
+
+      void write_bits( [[maybe_unused]] ulong value, std::size_t n ) noexcept
+      {
+        m_bit_count += n;
+      }
+
+      void write_value( header_format format, ulong value ) noexcept
+      {
+        if ( format == header_format::fibonacci )
+        {
+          fib::write_code( *this, value + 1u );
+          return;
+        }
+        do
+        {
+          value >>= 7u;
+          m_bit_count += 8u;
+        } while ( value != 0u );
+      }
+
+      std::size_t byte_count() const noexcept
+      {
+        return ( m_bit_count + 7u ) >> 3u;
+      }
+
+    private:
+      std::size_t m_bit_count = 0u;
+    };
+
+    class header_reader
+    {
+    public:
+      explicit header_reader( byte const *data_p ) noexcept :
+        m_data_p( data_p )
+      {
+      }
+
+      bool read_bit() noexcept
+      {
+        auto bit = ( m_data_p[ m_bit_count >> 3u ] >> ( m_bit_count & 7u ) ) &
+                   1u;
+        ++m_bit_count;
+        return bit != 0u;
+      }
+
+      ulong read_bits( std::size_t n ) noexcept
+      {
+        ulong result = 0u;
+        for ( std::size_t i = 0u; i < n; ++i )
+        {
+          result |= static_cast< ulong >( read_bit() ) << i;
+        }
+        return result;
+      }
+
+      ulong read_value( header_format format )
+      {
+        if ( format == header_format::fibonacci )
+        {
+          return fib::read_code( *this ) - 1u;
+        }
+        ulong result = 0u;
+        for ( std::size_t shift = 0u;; shift += 7u )
+        {
+          auto group = read_bits( 8u );
+          result |= ( group & 0x7fu ) << shift;
+          if ( ( group & 0x80u ) == 0u )
+          {
+            return result;
+          }
+        }
+      }
+
+      std::size_t byte_count() const noexcept
+      {
+        return ( m_bit_count + 7u ) >> 3u;
+      }
+
+    private:
+      byte const *m_data_p;
+      std::size_t m_bit_count = 0u;
+    };
+
+    inline std::size_t length_size( std::size_t length ) noexcept
+    {
+      std::size_t result = 1u;
+      while ( length >= 0x80u )
+      {
+        length >>= 7u;
+        ++result;
+      }
+      return result;
+    }
+
+    template < typename T >
+    std::size_t present_count( T const *freqs_p, std::size_t size ) noexcept
+    {
+      std::size_t result = 0u;
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        result += freqs_p[ i ] != 0u ? 1u : 0u;
+      }
+      return result;
+    }
+
+    // symbols listed by gaps unless it costs more than bitmap
+    template < typename T >
+    bool use_gaps( T const *freqs_p, std::size_t size ) noexcept
+    {
+      return present_count( freqs_p, size ) * 8u < size;
+    }
+
+    // list of symbols with non-zero frequency
+    template < typename _Writer, typename T >
+    void write_symbol_list( _Writer &writer, header_format format,
+                            bool gaps, T const *freqs_p, std::size_t size )
+    {
+      if ( gaps )
+      {
+        writer.write_value( format, present_count( freqs_p, size ) );
+        std::size_t next = 0u;
+        for ( std::size_t i = 0u; i < size; ++i )
+        {
+          if ( freqs_p[ i ] != 0u )
+          {
+            writer.write_value( format, i - next );
+            next = i + 1u;
+          }
+        }
+      }
+      else
+      {
+        for ( std::size_t i = 0u; i < size; ++i )
+        {
+          writer.write_bit( freqs_p[ i ] != 0u );
+        }
+      }
+    }
+
+    template < typename _Writer, typename T >
+    void write_payload( _Writer &writer, header_format format,
+                        bool gaps, T const *freqs_p, std::size_t size,
+                        ulong total )
+    {
+      std::size_t last = size;
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        if ( freqs_p[ i ] != 0u )
+        {
+          last = i;
+        }
+      }
+
+      write_symbol_list( writer, format, gaps, freqs_p, size );
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        if ( freqs_p[ i ] != 0u && ( i != last || total == 0u ) )
+        {
+          writer.write_value( format, static_cast< ulong >( freqs_p[ i ] ) -
+                                        1u );
+        }
+      }
+    }
+
+    // marks listed symbols with 1 ( others with 0 ), returns last of them
+    //  ( or size if there are none ); throws std::invalid_argument if gaps
+    //  lead past size
+    template < typename T >
+    std::size_t read_symbol_list( header_reader &reader, header_format format,
+                                  bool gaps, T *freqs_p, std::size_t size )
+    {
+      std::memset( static_cast< void * >( freqs_p ), 0, size * sizeof( T ) );
+
+      std::size_t last = size;
+      if ( gaps )
+      {
+        auto present = reader.read_value( format );
+        std::size_t next = 0u;
+        for ( ulong i = 0u; i < present; ++i )
+        {
+          auto gap = reader.read_value( format );
+          if ( gap >= size - next )
+          {
+            throw std::invalid_argument( "header symbol out of range" );
+          }
+          last = next + static_cast< std::size_t >( gap );
+          freqs_p[ last ] = 1u;
+          next = last + 1u;
+        }
+      }
+      else
+      {
+        for ( std::size_t i = 0u; i < size; ++i )
+        {
+          if ( reader.read_bit() )
+          {
+            freqs_p[ i ] = 1u;
+            last = i;
+          }
+        }
+      }
+      return last;
+    }
+
+    // throws std::invalid_argument if frequencies listed leave nothing of
+    //  known total to last present symbol
+    template < typename T >
+    void read_payload( header_reader &reader, header_format format, bool gaps,
+                       T *freqs_p, std::size_t size, ulong total )
+    {
+      // present symbols are marked with 1 first
+      auto last = read_symbol_list( reader, format, gaps, freqs_p, size );
+
+      ulong sum = 0u;
+      for ( std::size_t i = 0u; i < size; ++i )
+      {
+        if ( freqs_p[ i ] != 0u && ( i != last || total == 0u ) )
+        {
+          auto value = reader.read_value( format );
+          if ( total != 0u && value >= total - sum )
+          {
+            throw std::invalid_argument( "header frequencies exceed total" );
+          }
+          freqs_p[ i ] = static_cast< T >( value + 1u );
+          sum += freqs_p[ i ];
+        }
+      }
+      if ( last < size && total != 0u )
+      {
+        if ( sum >= total )
+        {
+          throw std::invalid_argument( "header frequencies exceed total" );
+        }
+        freqs_p[ last ] = static_cast< T >( total - sum );
+      }
+    }
+
+    // payload length from last 7-bit group, so that it is read first from end
+    template < std::size_t _BufSize >
+    void write_length( bit_buffer< _BufSize > &buf, std::size_t length )
+    {
+      byte groups_p[ 10 ];
+      std::size_t n = 0u;
+      do
+      {
+        groups_p[ n ] = static_cast< byte >( length & 0x7fu );
+        length >>= 7u;
+        if ( length != 0u )
+        {
+          groups_p[ n ] |= 0x80u;
+        }
+        ++n;
+      } while ( length != 0u );
+      for ( std::size_t i = n; i > 0u; --i )
+      {
+        buf.write_value( groups_p[ i - 1u ] );
+      }
+    }
+
+    // reads payload length ending at cursor and moves cursor before it
+    template < std::size_t _BufSize >
+    std::size_t read_length_reverse( bit_buffer< _BufSize > &buf )
+    {
+      std::size_t length = 0u;
+      for ( std::size_t shift = 0u;; shift += 7u )
+      {
+        auto group = buf.template read_value_reverse< byte >();
+        length |= static_cast< std::size_t >( group & 0x7fu ) << shift;
+        if ( ( group & 0x80u ) == 0u )
+        {
+          return length;
+        }
+      }
+    }
+  }  // namespace detail
+
+  // writes header of size frequencies; total ( sum of frequencies ) is
+  //  either known to reader or 0
+  template < typename T, std::size_t _BufSize >
+  void write_header_freqs( bit_buffer< _BufSize > &buf, T const *freqs_p,
+                           std::size_t size, ulong total,
+                           header_format format = default_header_format )
+  {
+    auto writer = detail::header_writer{};
+    write_header_freqs( buf, writer, freqs_p, size, total, format );
+  }
+
+  // same with payload collected in writer reused between calls
+  template < typename T, std::size_t _BufSize >
+  void write_header_freqs( bit_buffer< _BufSize > &buf,
+                           detail::header_writer &writer, T const *freqs_p,
+                           std::size_t size, ulong total,
+                           header_format format = default_header_format )
+  {
+    writer.clear();
+    auto tag = static_cast< byte >( format );
+    if ( format == header_format::raw )
+    {
+      buf.write_value( tag );
+      buf.write( size * sizeof( T ), freqs_p );
+    }
+    else
+    {
+      auto gaps = detail::use_gaps( freqs_p, size );
+      if ( gaps )
+      {
+        tag |= detail::header_gaps_flag;
+      }
+      buf.write_value( tag );
+      detail::write_payload( writer, format, gaps, freqs_p, size, total );
+      buf.write( writer.bytes().size(), writer.bytes().data() );
+    }
+
+    detail::write_length( buf, format == header_format::raw
+                                 ? size * sizeof( T )
+                                 : writer.bytes().size() );
+  }
+
+  // length in bytes of header written by write_header_freqs
+  template < typename T >
+  std::size_t header_freqs_size( T const *freqs_p, std::size_t size,
+                                 ulong total,
+                                 header_format format = default_header_format )
+  {
+    auto length = size * sizeof( T );
+    if ( format != header_format::raw )
+    {
+      auto counter = detail::header_counter{};
+      detail::write_payload( counter, format,
+                             detail::use_gaps( freqs_p, size ), freqs_p, size,
+                             total );
+      length = counter.byte_count();
+    }
+    return 1u + length + detail::length_size( length );
+  }
+
+  // reads header at cursor and moves cursor past it
+  template < typename T, std::size_t _BufSize >
+  void read_header_freqs( bit_buffer< _BufSize > &buf, T *freqs_p,
+                          std::size_t size, ulong total )
+  {
+    auto tag = buf.template read_value< byte >();
+    auto format =
+      static_cast< header_format >( tag & detail::header_format_mask );
+
+    std::size_t length = 0u;
+    if ( format == header_format::raw )
+    {
+      buf.read( size * sizeof( T ), freqs_p );
+      length = size * sizeof( T );
+    }
+    else
+    {
+      auto reader = detail::header_reader( buf.curr() );
+      detail::read_payload( reader, format,
+                            ( tag & detail::header_gaps_flag ) != 0u,
+                            freqs_p, size, total );
+      length = reader.byte_count();
+      buf.advance( length );
+    }
+    buf.advance( detail::length_size( length ) );
+  }
+
+  // reads header ending at cursor and moves cursor to its beginning
+  template < typename T, std::size_t _BufSize >
+  void read_header_freqs_reverse( bit_buffer< _BufSize > &buf, T *freqs_p,
+                                  std::size_t size, ulong total )
+  {
+    auto length = detail::read_length_reverse( buf );
+    buf.reverse( length + 1u );
+    read_header_freqs( buf, freqs_p, size, total );
+    buf.reverse( length + 1u + detail::length_size( length ) );
+  }
+
+  // reads legacy header ( cf. header_format ) of size symbols ending at
+  //  cursor and moves cursor to its beginning; throws std::invalid_argument
+  //  unless it fits before cursor and C(S) grows from 0 up to total
+  template < typename T, std::size_t _BufSize >
+  void read_legacy_header_freqs_reverse( bit_buffer< _BufSize > &buf,
+                                         T *freqs_p, std::size_t size,
+                                         ulong total )
+  {
+    if ( static_cast< std::size_t >( buf.curr() - buf.data() ) <
+         size * sizeof( word ) )
+    {
+      throw std::invalid_argument( "legacy header truncated" );
+    }
+    auto next = total;
+    for ( std::size_t i = size; i > 0u; --i )
+    {
+      auto c = static_cast< ulong >( buf.read_word_reverse() );
+      if ( c > next )
+      {
+        throw std::invalid_argument( "legacy header not monotone" );
+      }
+      freqs_p[ i - 1u ] = static_cast< T >( next - c );
+      next = c;
+    }
+    if ( next != 0u )
+    {
+      throw std::invalid_argument( "legacy header not starting at 0" );
+    }
+  }
+
+  // writes combined header of count tables of size frequencies each ( stored
+  //  one after another ); payload lists tables with any symbol present
+  //  ( as bitmap or by gaps ), each followed by its own compact payload
+  template < typename T, std::size_t _BufSize >
+  void write_header_tables( bit_buffer< _BufSize > &buf, T const *freqs_p,
+                            std::size_t count, std::size_t size, ulong total,
+                            header_format format = default_header_format )
+  {
+    auto writer = detail::header_writer{};
+    auto tag = static_cast< byte >( format );
+    if ( format == header_format::raw )
+    {
+      buf.write_value( tag );
+      buf.write( count * size * sizeof( T ), freqs_p );
+    }
+    else
+    {
+      auto used = std::vector< byte >( count );
+      for ( std::size_t t = 0u; t < count; ++t )
+      {
+        used[ t ] = detail::present_count( freqs_p + t * size, size ) != 0u
+                      ? 1u
+                      : 0u;
+      }
+      auto gaps = detail::use_gaps( used.data(), count );
+      if ( gaps )
+      {
+        tag |= detail::header_gaps_flag;
+      }
+      buf.write_value( tag );
+
+      detail::write_symbol_list( writer, format, gaps, used.data(), count );
+      for ( std::size_t t = 0u; t < count; ++t )
+      {
+        if ( used[ t ] != 0u )
+        {
+          auto const *row_p = freqs_p + t * size;
+          auto row_gaps = detail::use_gaps( row_p, size );
+          writer.write_bit( row_gaps );
+          detail::write_payload( writer, format, row_gaps, row_p, size,
+                                 total );
+        }
+      }
+      buf.write( writer.bytes().size(), writer.bytes().data() );
+    }
+
+    detail::write_length( buf, format == header_format::raw
+                                 ? count * size * sizeof( T )
+                                 : writer.bytes().size() );
+  }
+
+  // length in bytes of header written by write_header_tables
+  template < typename T >
+  std::size_t header_tables_size( T const *freqs_p, std::size_t count,
+                                  std::size_t size, ulong total,
+                                  header_format format = default_header_format )
+  {
+    auto length = count * size * sizeof( T );
+    if ( format != header_format::raw )
+    {
+      auto counter = detail::header_counter{};
+      auto used = std::vector< byte >( count );
+      for ( std::size_t t = 0u; t < count; ++t )
+      {
+        used[ t ] = detail::present_count( freqs_p + t * size, size ) != 0u
+                      ? 1u
+                      : 0u;
+      }
+      detail::write_symbol_list( counter, format,
+                                 detail::use_gaps( used.data(), count ),
+                                 used.data(), count );
+      for ( std::size_t t = 0u; t < count; ++t )
+      {
+        if ( used[ t ] != 0u )
+        {
+          auto const *row_p = freqs_p + t * size;
+          auto row_gaps = detail::use_gaps( row_p, size );
+          counter.write_bit( row_gaps );
+          detail::write_payload( counter, format, row_gaps, row_p, size,
+                                 total );
+        }
+      }
+      length = counter.byte_count();
+    }
+    return 1u + length + detail::length_size( length );
+  }
+
+  // reads combined header at cursor and moves cursor past it; frequencies of
+  //  tables not listed are 0
+  template < typename T, std::size_t _BufSize >
+  void read_header_tables( bit_buffer< _BufSize > &buf, T *freqs_p,
+                           std::size_t count, std::size_t size, ulong total )
+  {
+    auto tag = buf.template read_value< byte >();
+    auto format =
+      static_cast< header_format >( tag & detail::header_format_mask );
+
+    std::size_t length = 0u;
+    if ( format == header_format::raw )
+    {
+      buf.read( count * size * sizeof( T ), freqs_p );
+      length = count * size * sizeof( T );
+    }
+    else
+    {
+      auto reader = detail::header_reader( buf.curr() );
+      auto used = std::vector< byte >( count );
+      detail::read_symbol_list( reader, format,
+                                ( tag & detail::header_gaps_flag ) != 0u,
+                                used.data(), count );
+      for ( std::size_t t = 0u; t < count; ++t )
+      {
+        auto *row_p = freqs_p + t * size;
+        if ( used[ t ] != 0u )
+        {
+          auto row_gaps = reader.read_bit();
+          detail::read_payload( reader, format, row_gaps, row_p, size, total );
+        }
+        else
+        {
+          std::memset( static_cast< void * >( row_p ), 0, size * sizeof( T ) );
+        }
+      }
+      length = reader.byte_count();
+      buf.advance( length );
+    }
+    buf.advance( detail::length_size( length ) );
+  }
+
+}  // namespace coding
+
+#endif  // !CODING_HEADER_CODEC_H_INCLUDED
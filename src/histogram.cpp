@@ -0,0 +1,71 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace coding
+{
+  static_assert( histogram_banks == 4u, "byte counting unrolled for 4 banks" );
+
+  void count_bytes( byte const *beg_p, byte const *end_p,
+                    uint *counts_p ) noexcept
+  {
+    uint banks_p[ histogram_banks ][ 256 ] = {};
+    auto n = static_cast< std::size_t >( end_p - beg_p );
+
+    // eight bytes loaded at once are spread over banks
+    std::size_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      ulong v;
+      std::memcpy( &v, beg_p + i, sizeof( v ) );
+      ++banks_p[ 0 ][ v & 0xffu ];
+      ++banks_p[ 1 ][ ( v >> 8u ) & 0xffu ];
+      ++banks_p[ 2 ][ ( v >> 16u ) & 0xffu ];
+      ++banks_p[ 3 ][ ( v >> 24u ) & 0xffu ];
+      ++banks_p[ 0 ][ ( v >> 32u ) & 0xffu ];
+      ++banks_p[ 1 ][ ( v >> 40u ) & 0xffu ];
+      ++banks_p[ 2 ][ ( v >> 48u ) & 0xffu ];
+      ++banks_p[ 3 ][ v >> 56u ];
+    }
+    for ( ; i < n; ++i )
+    {
+      ++banks_p[ i % histogram_banks ][ beg_p[ i ] ];
+    }
+
+    for ( std::size_t s = 0u; s < 256u; ++s )
+    {
+      counts_p[ s ] +=
+        banks_p[ 0 ][ s ] + banks_p[ 1 ][ s ] + banks_p[ 2 ][ s ] +
+        banks_p[ 3 ][ s ];
+    }
+  }
+
+  void count_bytes( byte const *beg_p, byte const *end_p, uint *counts_p,
+                    thread_pool &pool )
+  {
+    auto n = static_cast< std::size_t >( end_p - beg_p );
+    auto parts = std::min( pool.size(), n / histogram_chunk_size );
+    if ( parts <= 1u )
+    {
+      count_bytes( beg_p, end_p, counts_p );
+      return;
+    }
+
+    auto partial = std::vector< uint >( parts * 256u );
+    pool.run( parts, [ & ]( std::size_t k ) {
+      count_bytes( beg_p + k * n / parts, beg_p + ( k + 1u ) * n / parts,
+                   partial.data() + k * 256u );
+    } );
+
+    for ( std::size_t k = 0u; k < parts; ++k )
+    {
+      for ( std::size_t s = 0u; s < 256u; ++s )
+      {
+        counts_p[ s ] += partial[ k * 256u + s ];
+      }
+    }
+  }
+
+}  // namespace coding
@@ -0,0 +1,109 @@
+#ifndef CODING_HISTOGRAM_H_INCLUDED
+#define CODING_HISTOGRAM_H_INCLUDED
+
+#include "common.h"
+#include "data_block.h"
+#include "thread_pool.h"
+
+namespace coding
+{
+  // number of interleaved count banks; consecutive bytes are counted in
+  //  different banks, so that runs of same byte do not serialize on single
+  //  counter ( store to load forwarding )
+  constexpr std::size_t histogram_banks = 4u;
+
+  // smallest part of block counted by single thread
+  constexpr std::size_t histogram_chunk_size = 256u * 1024u;
+
+  // adds occurrences of every byte value in [beg_p, end_p) to counts_p[ 256 ]
+  void count_bytes( byte const *beg_p, byte const *end_p,
+                    uint *counts_p ) noexcept;
+
+  // same with parts of at least histogram_chunk_size bytes counted by pool
+  //  and partial histograms merged
+  void count_bytes( byte const *beg_p, byte const *end_p, uint *counts_p,
+                    thread_pool &pool );
+
+  namespace detail
+  {
+    template < std::size_t _DataSize, std::size_t SL, typename _CountBytes >
+    std::size_t count_symbols( data_block< _DataSize, SL > &data,
+                               uint *counts_p, _CountBytes count_bytes_fn )
+    {
+      auto cursor_pos = data.get_position();
+      std::size_t count = 0u;
+      if constexpr ( 8u % SL == 0u )
+      {
+        // symbols of partially read byte one by one, then whole bytes
+        while ( data && data.get_position().second != 0u )
+        {
+          ++counts_p[ data.read_symbol() ];
+          ++count;
+        }
+        auto const *beg_p = data.data() + data.get_position().first;
+        auto const *end_p = data.data() + data.raw_byte_count();
+        if ( beg_p < end_p )
+        {
+          if constexpr ( SL == 8u )
+          {
+            count_bytes_fn( beg_p, end_p, counts_p );
+          }
+          else
+          {
+            // every byte value adds its 8 / SL symbols
+            uint bytes_p[ 256 ] = {};
+            count_bytes_fn( beg_p, end_p, bytes_p );
+            for ( std::size_t v = 0u; v < 256u; ++v )
+            {
+              for ( std::size_t k = 0u; k < 8u && bytes_p[ v ] != 0u;
+                    k += SL )
+              {
+                counts_p[ ( v >> k ) & ( ( 1u << SL ) - 1u ) ] +=
+                  bytes_p[ v ];
+              }
+            }
+          }
+          count += static_cast< std::size_t >( end_p - beg_p ) * ( 8u / SL );
+        }
+      }
+      else
+      {
+        // symbols crossing bytes are read one by one
+        while ( data )
+        {
+          ++counts_p[ data.read_symbol() ];
+          ++count;
+        }
+      }
+      data.set_position( cursor_pos );
+      return count;
+    }
+  }  // namespace detail
+
+  // adds occurrences of symbols from cursor to end of block to
+  //  counts_p[ 2^SL ] and returns their number; cursor is kept
+  template < std::size_t _DataSize, std::size_t SL >
+  std::size_t count_symbols( data_block< _DataSize, SL > &data,
+                             uint *counts_p )
+  {
+    return detail::count_symbols(
+      data, counts_p,
+      []( byte const *beg_p, byte const *end_p, uint *bytes_p ) {
+        count_bytes( beg_p, end_p, bytes_p );
+      } );
+  }
+
+  template < std::size_t _DataSize, std::size_t SL >
+  std::size_t count_symbols( data_block< _DataSize, SL > &data,
+                             uint *counts_p, thread_pool &pool )
+  {
+    return detail::count_symbols(
+      data, counts_p,
+      [ &pool ]( byte const *beg_p, byte const *end_p, uint *bytes_p ) {
+        count_bytes( beg_p, end_p, bytes_p, pool );
+      } );
+  }
+
+}  // namespace coding
+
+#endif  // !CODING_HISTOGRAM_H_INCLUDED
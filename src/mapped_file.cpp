@@ -0,0 +1,90 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coding
+{
+  namespace
+  {
+    // closes descriptor ( if open ) and reports last error
+    [[noreturn]] void fail( int fd, char const *filepath )
+    {
+      auto err = errno;
+      if ( fd >= 0 )
+      {
+        ::close( fd );
+      }
+      throw std::system_error( err, std::generic_category(), filepath );
+    }
+  }  // namespace
+
+  mapped_file::mapped_file( char const *filepath )
+  {
+    auto fd = ::open( filepath, O_RDONLY );
+    if ( fd < 0 )
+    {
+      fail( fd, filepath );
+    }
+
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 )
+    {
+      fail( fd, filepath );
+    }
+
+    // empty file cannot be mapped and stays closed
+    auto size = static_cast< std::size_t >( st.st_size );
+    if ( size > 0u )
+    {
+      auto addr_p = ::mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( addr_p == MAP_FAILED )
+      {
+        fail( fd, filepath );
+      }
+      // advice is only a hint, failure is not an error
+      ::madvise( addr_p, size, MADV_SEQUENTIAL );
+      m_data_p = static_cast< byte const * >( addr_p );
+      m_size = size;
+    }
+
+    // mapping stays valid after descriptor is closed
+    ::close( fd );
+  }
+
+  mapped_file::mapped_file( mapped_file &&other ) noexcept :
+    m_data_p( std::exchange( other.m_data_p, nullptr ) ),
+    m_size( std::exchange( other.m_size, 0u ) )
+  {
+  }
+
+  mapped_file &mapped_file::operator=( mapped_file &&other ) noexcept
+  {
+    if ( this != &other )
+    {
+      close();
+      m_data_p = std::exchange( other.m_data_p, nullptr );
+      m_size = std::exchange( other.m_size, 0u );
+    }
+    return *this;
+  }
+
+  mapped_file::~mapped_file() noexcept { close(); }
+
+  void mapped_file::close() noexcept
+  {
+    if ( m_data_p != nullptr )
+    {
+      ::munmap( const_cast< byte * >( m_data_p ), m_size );
+    }
+    m_data_p = nullptr;
+    m_size = 0u;
+  }
+
+}  // namespace coding
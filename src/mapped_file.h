@@ -0,0 +1,44 @@
+#ifndef CODING_MAPPED_FILE_H_INCLUDED
+#define CODING_MAPPED_FILE_H_INCLUDED
+
+#include "common.h"
+#include "data_block.h"
+
+namespace coding
+{
+  // read-only memory mapping of whole file, advised for sequential access;
+  //  failures are reported with std::system_error
+  class mapped_file
+  {
+  public:
+    mapped_file() noexcept = default;
+    explicit mapped_file( char const *filepath );
+    mapped_file( mapped_file const & ) = delete;
+    mapped_file( mapped_file &&other ) noexcept;
+    mapped_file &operator=( mapped_file const & ) = delete;
+    mapped_file &operator=( mapped_file &&other ) noexcept;
+    ~mapped_file() noexcept;
+
+    std::size_t size() const noexcept { return m_size; }
+
+    byte const *data() const noexcept { return m_data_p; }
+
+    bool is_open() const noexcept { return m_data_p != nullptr; }
+
+    void close() noexcept;
+
+    // read-only block of SL-bit symbols over mapped bytes ( no copy )
+    template < std::size_t SL >
+    data_block< read_only_view, SL > view() const noexcept
+    {
+      return data_block< read_only_view, SL >( m_data_p, m_size );
+    }
+
+  private:
+    byte const *m_data_p = nullptr;
+    std::size_t m_size = 0u;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_MAPPED_FILE_H_INCLUDED
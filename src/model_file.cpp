@@ -0,0 +1,28 @@
+#include "model_file.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <system_error>
+
+namespace coding
+{
+  void write_file( char const *filepath, bit_buffer< dynamic_size > &buf )
+  {
+    auto *file_p = std::fopen( filepath, "wb" );
+    if ( file_p == nullptr )
+    {
+      throw std::system_error( errno, std::generic_category(), filepath );
+    }
+    auto written = std::fwrite( buf.data(), 1u, buf.size(), file_p );
+    auto err = written != buf.size() ? ( errno != 0 ? errno : EIO ) : 0;
+    if ( std::fclose( file_p ) != 0 && err == 0 )
+    {
+      err = errno;
+    }
+    if ( err != 0 )
+    {
+      throw std::system_error( err, std::generic_category(), filepath );
+    }
+  }
+
+}  // namespace coding
@@ -0,0 +1,195 @@
+#ifndef CODING_MODEL_FILE_H_INCLUDED
+#define CODING_MODEL_FILE_H_INCLUDED
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "common.h"
+#include "data_block.h"
+#include "freq_normalize.h"
+#include "header_codec.h"
+#include "histogram.h"
+#include "mapped_file.h"
+
+namespace coding
+{
+  // trained model shared by encoder and decoder, so that blocks are coded
+  //  with model id instead of frequency header
+  //
+  // model file layout:
+  //  [magic][version][symbol length][numeral base][model id][header]
+  // magic and model id are uint, the rest bytes; header is frequency header
+  //  of table ( cf. header_codec.h )
+
+  constexpr uint model_file_magic = 0x4c444d52u;  // "RMDL"
+  constexpr byte model_file_version = 1u;
+
+  // writes whole buffer to file; failures are reported with std::system_error
+  void write_file( char const *filepath, bit_buffer< dynamic_size > &buf );
+
+  // counts symbols of sample corpus and builds normalized model from them
+  template < std::size_t SL >
+  class model_trainer
+  {
+  public:
+    // adds symbols from cursor to end of block; cursor is kept
+    template < std::size_t _DataSize >
+    void add( data_block< _DataSize, SL > &data )
+    {
+      m_symbol_count += count_symbols( data, m_counts_p );
+      ++m_block_count;
+    }
+
+    std::size_t symbol_count() const noexcept { return m_symbol_count; }
+
+    std::size_t block_count() const noexcept { return m_block_count; }
+
+    // frequencies summing to 2^N; symbols missing in corpus are counted
+    //  once, so that blocks with them can still be coded
+    template < std::size_t N >
+    void train( num_word< N > ( &freqs_p )[ 1u << SL ] ) const
+    {
+      static_assert( SL <= N, "numeral base too small for alphabet" );
+      uint counts_p[ 1u << SL ];
+      for ( std::size_t i = 0u; i < ( 1u << SL ); ++i )
+      {
+        counts_p[ i ] = std::max( m_counts_p[ i ], 1u );
+      }
+      normalize_freqs( counts_p, 1u << SL, 1u << N );
+      for ( std::size_t i = 0u; i < ( 1u << SL ); ++i )
+      {
+        freqs_p[ i ] = static_cast< num_word< N > >( counts_p[ i ] );
+      }
+    }
+
+    template < std::size_t N,
+               template < std::size_t, std::size_t > class _FreqTable >
+    _FreqTable< SL, N > build() const
+    {
+      num_word< N > freqs_p[ 1u << SL ];
+      train< N >( freqs_p );
+      return _FreqTable< SL, N >( freqs_p );
+    }
+
+  private:
+    uint m_counts_p[ 1u << SL ] = {};
+    std::size_t m_symbol_count = 0u;
+    std::size_t m_block_count = 0u;
+  };
+
+  template < std::size_t SL, std::size_t N,
+             template < std::size_t, std::size_t > class _FreqTable >
+  void write_model( bit_buffer< dynamic_size > &buf, uint id,
+                    _FreqTable< SL, N > const &model )
+  {
+    buf.write_value( model_file_magic );
+    buf.write_value( model_file_version );
+    buf.write_value( static_cast< byte >( SL ) );
+    buf.write_value( static_cast< byte >( N ) );
+    buf.write_value( id );
+    model.write_header( buf );
+  }
+
+  // reads model at cursor and returns its id; throws std::runtime_error if
+  //  it is not model of SL-bit symbols with numeral base 2^N
+  template < std::size_t SL, std::size_t N,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize >
+  std::pair< uint, _FreqTable< SL, N > >
+  read_model( bit_buffer< _BufSize > &buf )
+  {
+    // fixed part before header
+    constexpr std::size_t prefix = 2u * sizeof( uint ) + 3u;
+    auto left = buf.size() - static_cast< std::size_t >( buf.curr() -
+                                                         buf.data() );
+    if ( left < prefix ||
+         buf.template read_value< uint >() != model_file_magic )
+    {
+      throw std::runtime_error( "not a model file" );
+    }
+    if ( buf.template read_value< byte >() != model_file_version )
+    {
+      throw std::runtime_error( "unsupported model file version" );
+    }
+    if ( buf.template read_value< byte >() != SL ||
+         buf.template read_value< byte >() != N )
+    {
+      throw std::runtime_error( "model of other symbol length or base" );
+    }
+    auto id = buf.template read_value< uint >();
+
+    // static model checks frequencies
+    num_word< N > freqs_p[ 1u << SL ];
+    read_header_freqs( buf, freqs_p, 1u << SL, 1u << N );
+    return { id, _FreqTable< SL, N >( freqs_p ) };
+  }
+
+  template < std::size_t SL, std::size_t N,
+             template < std::size_t, std::size_t > class _FreqTable >
+  void save_model( char const *filepath, uint id,
+                   _FreqTable< SL, N > const &model )
+  {
+    auto buf = bit_buffer< dynamic_size >();
+    write_model( buf, id, model );
+    write_file( filepath, buf );
+  }
+
+  // models loaded once and looked up by id found in coded blocks
+  template < std::size_t SL, std::size_t N,
+             template < std::size_t, std::size_t > class _FreqTable >
+  class model_set
+  {
+  public:
+    using table_type = _FreqTable< SL, N >;
+
+    // replaces model of same id
+    void add( uint id, table_type const &model )
+    {
+      auto it =
+        std::find_if( m_models.begin(), m_models.end(),
+                      [ id ]( auto const &m ) { return m.first == id; } );
+      if ( it != m_models.end() )
+      {
+        it->second = model;
+      }
+      else
+      {
+        m_models.emplace_back( id, model );
+      }
+    }
+
+    // adds model from file and returns its id
+    uint load( char const *filepath )
+    {
+      auto file = mapped_file( filepath );
+      auto buf = bit_buffer< read_only_view >( file.data(), file.size() );
+      auto [ id, model ] = read_model< SL, N, _FreqTable >( buf );
+      add( id, model );
+      return id;
+    }
+
+    std::size_t size() const noexcept { return m_models.size(); }
+
+    // throws std::out_of_range for unknown id
+    table_type const &find( uint id ) const
+    {
+      for ( auto const &m : m_models )
+      {
+        if ( m.first == id )
+        {
+          return m.second;
+        }
+      }
+      throw std::out_of_range( "unknown model id" );
+    }
+
+  private:
+    std::vector< std::pair< uint, table_type > > m_models;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_MODEL_FILE_H_INCLUDED
@@ -0,0 +1,5 @@
+#include "num_enc_table.h"
+
+namespace coding
+{
+}  // namespace coding
@@ -0,0 +1,104 @@
+#ifndef CODING_NUM_ENC_TABLE_H_INCLUDED
+#define CODING_NUM_ENC_TABLE_H_INCLUDED
+
+#include <cstdio>
+
+#include "common.h"
+
+namespace coding
+{
+  // encoder-side data of single symbol; x / f(s) is replaced with
+  //  multiplication by reciprocal (cf. Granlund & Montgomery), exact for any
+  //  32-bit state: q = ( x + ( ( x * rcp_freq ) >> 32 ) ) >> rcp_shift
+  struct rans_enc_symbol
+  {
+    uint x_max;      // renormalization bound f(s) << ( 32 - N ), saturated
+    uint rcp_freq;   // ceil( 2^( 32 + rcp_shift ) / f(s) ) - 2^32
+    uint bias;       // C(s)
+    word freq;       // f(s)
+    word rcp_shift;  // ceil( log2( f(s) ) )
+
+    ulong quotient( ulong x ) const noexcept
+    {
+      return ( x + ( ( x * static_cast< ulong >( rcp_freq ) ) >> 32ul ) ) >>
+             static_cast< ulong >( rcp_shift );
+    }
+  };
+
+  static_assert( sizeof( rans_enc_symbol ) == 16u,
+                 "encoder symbol should fit in quarter of cache line" );
+
+  // table of encoder-side symbol data built from numeral frequency table
+  template < std::size_t SL, std::size_t N >
+  class num_enc_table
+  {
+  public:
+    static_assert( N <= 15u, "encoder symbols store 16-bit frequencies" );
+
+    num_enc_table() noexcept {}
+
+    template < typename _FreqTable >
+    explicit num_enc_table( _FreqTable const &ft ) noexcept
+    {
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        init_symbol( m_symbols_p[ i ], static_cast< ulong >( ft.f( i ) ),
+                     static_cast< ulong >( ft.cdf( i ) ) );
+      }
+    }
+
+    static std::size_t size() noexcept { return 1u << SL; }
+
+    rans_enc_symbol const &operator[]( std::size_t index ) const noexcept
+    {
+      return m_symbols_p[ index ];
+    }
+
+    void display()
+    {
+      std::printf( " S    f(S)     C(S)      x_max   rcp(S) shift\n" );
+      for ( std::size_t i = 0; i < size(); ++i )
+      {
+        auto const &e = m_symbols_p[ i ];
+        std::printf( " %02x %8u %8u %10u %08x %5u\n", static_cast< uint >( i ),
+                     e.freq, e.bias, e.x_max, e.rcp_freq, e.rcp_shift );
+      }
+    }
+
+  private:
+    static void init_symbol( rans_enc_symbol &e, ulong f, ulong cdf ) noexcept
+    {
+      e.freq = static_cast< word >( f );
+      e.bias = static_cast< uint >( cdf );
+
+      // f(s) == 2^N leaves state unchanged and never needs renormalization
+      auto x_max = f << ( 32u - N );
+      e.x_max =
+        x_max > 0xfffffffful ? 0xffffffffu : static_cast< uint >( x_max );
+
+      // unused symbols are never encoded
+      if ( f == 0u )
+      {
+        e.rcp_freq = 0u;
+        e.rcp_shift = 0u;
+        return;
+      }
+
+      ulong shift = 0u;
+      while ( ( 1ul << shift ) < f )
+      {
+        ++shift;
+      }
+      e.rcp_shift = static_cast< word >( shift );
+      // powers of two reduce to plain shift with zero reciprocal
+      e.rcp_freq = static_cast< uint >(
+        ( ( 1ul << ( 32u + shift ) ) + f - 1u ) / f - ( 1ul << 32u ) );
+    }
+
+  private:
+    rans_enc_symbol m_symbols_p[ 1u << SL ] = {};
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_NUM_ENC_TABLE_H_INCLUDED
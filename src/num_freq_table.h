@@ -4,9 +4,14 @@
 #include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <stdexcept>
+#include <utility>
 
 #include "bit_buffer.h"
 #include "data_block.h"
+#include "freq_normalize.h"
+#include "header_codec.h"
+#include "histogram.h"
 
 namespace coding
 {
@@ -15,44 +20,124 @@ namespace coding
   class num_freq_table
   {
   public:
-    num_freq_table() noexcept {}
+    using num_type = num_word< N >;
+
+    constexpr num_freq_table() noexcept {}
+
+    // static model of frequencies summing to 2^N ( e.g. of well-known
+    //  distribution ), neither counted nor sent in header; built in constant
+    //  expression it is placed in read-only data; data coded with it is not
+    //  counted, so that every symbol must have nonzero frequency
+    constexpr explicit num_freq_table( num_type const ( &freqs_p )[ 1u << SL ] )
+    {
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        if ( freqs_p[ i ] == 0u )
+        {
+          throw std::invalid_argument( "static frequencies must be nonzero" );
+        }
+      }
+      init_cdf( freqs_p );
+      if ( static_cast< ulong >( m_cdf_p[ size() ] ) != num_base() )
+      {
+        throw std::invalid_argument( "static frequencies must sum to 2^N" );
+      }
+    }
 
     template < std::size_t _BufSize >
     explicit num_freq_table( bit_buffer< _BufSize > &buf )
     {
-      buf.read( size() * sizeof( word ), m_cdf_p );
-      m_cdf_p[ size() ] = num_base();
+      assign_header( buf );
     }
 
     template < std::size_t _DataSize >
     explicit num_freq_table( data_block< _DataSize, SL > &data )
+    {
+      assign( data );
+    }
+
+    // symbols of large block counted by threads of pool
+    template < std::size_t _DataSize >
+    num_freq_table( data_block< _DataSize, SL > &data, thread_pool &pool )
     {
       uint freqs[ 1u << SL ] = {};
-      auto cursor_pos = data.get_position();
-      while ( data )
-      {
-        ++freqs[ data.read_symbol() ];
-        ++m_symbol_count;
-      }
-      data.set_position( cursor_pos );
+      m_symbol_count =
+        static_cast< uint >( count_symbols( data, freqs, pool ) );
+      init( freqs );
+      m_cdf_p[ size() ] = num_base();
+    }
+
+    // table of next block built in place
+    template < std::size_t _DataSize >
+    void assign( data_block< _DataSize, SL > &data )
+    {
+      uint freqs[ 1u << SL ] = {};
+      m_symbol_count = static_cast< uint >( count_symbols( data, freqs ) );
       init( freqs );
       m_cdf_p[ size() ] = num_base();
     }
 
-    static std::size_t size() noexcept { return 1u << SL; }
+    // same with normalization scratch kept by caller, cf. rans::codec_context
+    template < std::size_t _DataSize >
+    void assign( data_block< _DataSize, SL > &data, normalize_scratch &scratch )
+    {
+      uint freqs[ 1u << SL ] = {};
+      m_symbol_count = static_cast< uint >( count_symbols( data, freqs ) );
+      init( freqs, scratch );
+      m_cdf_p[ size() ] = num_base();
+    }
 
-    uint header_length() const noexcept
+    // reads header at cursor into table
+    template < std::size_t _BufSize >
+    void assign_header( bit_buffer< _BufSize > &buf )
     {
-      return static_cast< uint >( size() * sizeof( word ) ) << 3u;
+      num_type freqs[ 1u << SL ];
+      read_header_freqs( buf, freqs, size(), num_base() );
+      init_cdf( freqs );
     }
 
-    static word num_base() noexcept { return 1u << N; }
+    // reads header ending at cursor into table
+    template < std::size_t _BufSize >
+    void assign_header_reverse( bit_buffer< _BufSize > &buf )
+    {
+      num_type freqs[ 1u << SL ];
+      read_header_freqs_reverse( buf, freqs, size(), num_base() );
+      init_cdf( freqs );
+    }
 
-    word num_mask() const noexcept { return ( 1u << N ) - 1u; }
+    // reads legacy header ending at cursor into table, cf. header_format
+    template < std::size_t _BufSize >
+    void assign_legacy_header_reverse( bit_buffer< _BufSize > &buf )
+    {
+      num_type freqs[ 1u << SL ];
+      read_legacy_header_freqs_reverse( buf, freqs, size(), num_base() );
+      init_cdf( freqs );
+    }
 
-    word cdf( std::size_t index ) const noexcept { return m_cdf_p[ index ]; }
+    static constexpr std::size_t size() noexcept { return 1u << SL; }
 
-    word f( std::size_t index ) const noexcept
+    uint header_length( header_format format = default_header_format ) const
+    {
+      num_type freqs[ 1u << SL ];
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        freqs[ i ] = f( i );
+      }
+      return static_cast< uint >(
+               header_freqs_size( freqs, size(), num_base(), format ) )
+             << 3u;
+    }
+
+    static constexpr num_type num_base() noexcept { return 1u << N; }
+
+    constexpr num_type num_mask() const noexcept { return ( 1u << N ) - 1u; }
+
+    constexpr num_type cdf( std::size_t index ) const noexcept
+    {
+      return m_cdf_p[ index ];
+    }
+
+    constexpr num_type f( std::size_t index ) const noexcept
     {
       return m_cdf_p[ index + 1 ] - m_cdf_p[ index ];
     }
@@ -76,19 +161,33 @@ namespace coding
       return m_bits_per_symbol_theory;
     }
 
-    byte symbol( word value ) const noexcept
+    constexpr sym_word< SL > symbol( num_type value ) const noexcept
     {
-      // simple linear search
-      std::size_t i = 0u;
-      while ( i < size() )
+      if constexpr ( SL <= 8u )
       {
-        if ( value < m_cdf_p[ i ] )
+        // simple linear search
+        std::size_t i = 0u;
+        while ( i < size() )
         {
-          break;
+          if ( value < m_cdf_p[ i ] )
+          {
+            break;
+          }
+          ++i;
         }
-        ++i;
+        return static_cast< sym_word< SL > >( i - 1u );
+      }
+      else
+      {
+        // branchless binary search, large alphabets make linear one too slow
+        std::size_t i = 0u;
+        for ( std::size_t n = size(); n > 1u; n -= n >> 1u )
+        {
+          auto half = n >> 1u;
+          i = m_cdf_p[ i + half ] <= value ? i + half : i;
+        }
+        return static_cast< sym_word< SL > >( i );
       }
-      return static_cast< byte >( i - 1u );
     }
 
     void display()
@@ -106,9 +205,25 @@ namespace coding
     }
 
     template < std::size_t _BufSize >
-    void write_header( bit_buffer< _BufSize > &buf ) noexcept
+    void write_header( bit_buffer< _BufSize > &buf,
+                       header_format format = default_header_format ) const
     {
-      buf.write( ( size() ) * sizeof( word ), m_cdf_p );
+      auto writer = detail::header_writer{};
+      write_header( buf, writer, format );
+    }
+
+    // header payload collected in writer reused between calls
+    template < std::size_t _BufSize >
+    void write_header( bit_buffer< _BufSize > &buf,
+                       detail::header_writer &writer,
+                       header_format format = default_header_format ) const
+    {
+      num_type freqs[ 1u << SL ];
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        freqs[ i ] = f( i );
+      }
+      write_header_freqs( buf, writer, freqs, size(), num_base(), format );
     }
 
     bool operator==( num_freq_table const &other ) const noexcept
@@ -132,43 +247,59 @@ namespace coding
     static num_freq_table read_header_reverse( bit_buffer< _BufSize > &buf )
     {
       auto result = num_freq_table{};
-      buf.read_reverse( size() * sizeof( word ), result.m_cdf_p );
-      result.m_cdf_p[ size() ] = num_base();
+      result.assign_header_reverse( buf );
       return result;
     }
 
-    ulong rans_encode_adjust( byte s, ulong x ) const noexcept
+    constexpr ulong rans_encode_adjust( sym_word< SL > s,
+                                        ulong x ) const noexcept
+    {
+      return rans_encode_slot( ( x % static_cast< ulong >( f( s ) ) ) +
+                               static_cast< ulong >( cdf( s ) ) );
+    }
+
+    // maps symbol slot ( x mod f(s) ) + C(s) to its place in coded state
+    constexpr ulong rans_encode_slot( ulong slot ) const noexcept
     {
-      return ( x % static_cast< ulong >( f( s ) ) ) +
-             static_cast< ulong >( cdf( s ) );
+      return slot;
     }
 
-    std::pair< ulong, ulong > adjusted_f_and_cdf( [[maybe_unused]] word s,
-                                                  [[maybe_unused]] ulong value )
+    constexpr std::pair< ulong, ulong >
+    adjusted_f_and_cdf( [[maybe_unused]] word s,
+                        [[maybe_unused]] ulong value ) const noexcept
     {
       return std::make_pair( static_cast< ulong >( f( s ) ),
                              static_cast< ulong >( cdf( s ) ) );
     }
 
   private:
-    void init( uint *freqs_p ) noexcept
+    constexpr void init_cdf( num_type const *freqs_p ) noexcept
     {
-      init_bits_per_symbol_theory( freqs_p );
-
-      for ( std::size_t i = 1u; i < size(); ++i )
+      m_cdf_p[ 0 ] = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
       {
-        freqs_p[ i ] += freqs_p[ i - 1 ];
+        m_cdf_p[ i + 1 ] =
+          static_cast< num_type >( m_cdf_p[ i ] + freqs_p[ i ] );
       }
+    }
 
-      m_cdf_p[ 0 ] = 0u;
+    void init( uint *freqs_p )
+    {
+      auto scratch = normalize_scratch{};
+      init( freqs_p, scratch );
+    }
 
-      auto fac = static_cast< double >( num_base() ) /
-                 static_cast< double >( symbol_count() );
+    void init( uint *freqs_p, normalize_scratch &scratch )
+    {
+      init_bits_per_symbol_theory( freqs_p );
+
+      normalize_freqs( freqs_p, size(), num_base(), scratch );
 
-      for ( std::size_t i = 1u; i < size(); ++i )
+      m_cdf_p[ 0 ] = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
       {
-        m_cdf_p[ i ] = static_cast< word >(
-          static_cast< double >( freqs_p[ i - 1 ] ) * fac );
+        m_cdf_p[ i + 1 ] =
+          static_cast< num_type >( m_cdf_p[ i ] + freqs_p[ i ] );
       }
     }
 
@@ -188,7 +319,7 @@ namespace coding
     }
 
   private:
-    word m_cdf_p[ ( 1u << SL ) + 1u ] = {};
+    num_type m_cdf_p[ ( 1u << SL ) + 1u ] = {};
     uint m_symbol_count = 0u;
     double m_bits_per_symbol_theory = 0.0;
   };
@@ -3,66 +3,74 @@
 
 #include <cmath>
 #include <cstdio>
-#include <cstring>
-#include <fstream>
+#include <utility>
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+#include <immintrin.h>
+#endif
 
-#include "bit_buffer.h"
 #include "data_block.h"
 
 namespace coding
 {
-  // table storing symbol frequencies for certain data block
+  // adaptive table of symbol frequencies; starts uniform and after every
+  //  symbol moves each C(S) by 1/2^RATE of its distance towards target
+  //  concentrated on that symbol; targets keep one slot per symbol, so that
+  //  f(S) never drops below 1 and no header is needed ( encoder and decoder
+  //  update the table identically ); update and symbol search work on all
+  //  C(S) at once with SSE2 ( 8 lanes ), or AVX2 ( 16 lanes ) when built for
+  //  it ( cf. CODING_NATIVE_ARCH ), entropy is computed only on request
   template < std::size_t SL, std::size_t N, std::size_t RATE >
   class num_freq_table_adapt
   {
   public:
-    num_freq_table_adapt() noexcept {}
+    static_assert( SL < N, "numeral base too small for alphabet" );
+    static_assert( RATE > 0u && RATE < N, "unsupported adaptation rate" );
+    static_assert( N <= 15u, "C(S) is updated in signed 16-bit lanes" );
 
-    /*
-    template < std::size_t _BufSize >
-    explicit num_freq_table( bit_buffer< _BufSize > &buf )
-    {
-      buf.read( size() * sizeof( word ), m_cdf_p );
-      m_cdf_p[ size() ] = num_base();
-    }
-    */
+    using num_type = word;
 
-    template < std::size_t _DataSize >
-    explicit num_freq_table_adapt( data_block< _DataSize, SL > &data )
+    num_freq_table_adapt() noexcept
     {
-      double prob_hist[ _DataSize * ( 8u / SL ) + 1u ][ 1u << SL ] = {};
-      // uniform initialization
-      for ( std::size_t i = 1u; i < size(); ++i )
+      // uniform initialization; padding entries sit at their targets above
+      //  2^N, so that they never move and are never below searched value
+      for ( std::size_t i = 0u; i <= size(); ++i )
       {
-        m_cdf_p[ i ] = m_cdf_p[ i - 1 ] + ( 1u << ( N - SL ) );
+        m_cdf_p[ i ] = static_cast< num_type >( i << ( N - SL ) );
       }
-      m_cdf_p[ size() ] = num_base();
-      update_prob_hist( 0u, prob_hist );
-
-      display();
+      for ( std::size_t i = size() + 1u; i < padded_size; ++i )
+      {
+        m_cdf_p[ i ] = static_cast< num_type >( i + gap );
+      }
+    }
 
-      std::size_t index = 1u;
+    // table adapted to all symbols of data block
+    template < std::size_t _DataSize >
+    explicit num_freq_table_adapt( data_block< _DataSize, SL > &data ) :
+      num_freq_table_adapt()
+    {
+      auto cursor_pos = data.get_position();
       while ( data )
       {
-        adapt_cdf( index++, data.read_symbol(), prob_hist );
+        update( data.read_symbol() );
       }
-      m_symbol_count = static_cast< uint >( index - 1u );
-
-      write_history( "results/adaptive-history-short.tsv", _DataSize,
-                     prob_hist );
+      data.set_position( cursor_pos );
     }
 
     static std::size_t size() noexcept { return 1u << SL; }
 
     uint header_length() const noexcept { return 0u; }
 
-    static word num_base() noexcept { return 1u << N; }
+    static num_type num_base() noexcept { return 1u << N; }
 
-    word num_mask() const noexcept { return ( 1u << N ) - 1u; }
+    num_type num_mask() const noexcept { return ( 1u << N ) - 1u; }
 
-    word cdf( std::size_t index ) const noexcept { return m_cdf_p[ index ]; }
+    num_type cdf( std::size_t index ) const noexcept
+    {
+      return m_cdf_p[ index ];
+    }
 
-    word f( std::size_t index ) const noexcept
+    num_type f( std::size_t index ) const noexcept
     {
       return m_cdf_p[ index + 1 ] - m_cdf_p[ index ];
     }
@@ -79,29 +87,117 @@ namespace coding
              static_cast< double >( num_base() );
     }
 
+    // number of updates so far
     uint symbol_count() const noexcept { return m_symbol_count; }
 
+    // entropy of current state of table
     double bits_per_symbol_theory() const noexcept
     {
-      return m_bits_per_symbol_theory;
+      // cf. Shannon
+      double result = 0.0;
+      for ( std::size_t i = 0; i < size(); ++i )
+      {
+        auto pr = p( i );
+        if ( pr != 0.0 )
+        {
+          result -= pr * std::log2( pr );
+        }
+      }
+      return result;
     }
 
-    byte symbol( word value ) const noexcept
+    // symbol S with C(S) <= value < C(S + 1), found by counting C(i) not
+    //  above value ( C(0) always counts ) in per-lane counters
+    byte symbol( num_type value ) const noexcept
     {
-      // simple linear search
-      std::size_t i = 0u;
-      while ( i < size() )
+#if defined( __AVX2__ )
+      auto v = _mm256_set1_epi16( static_cast< short >( value ) );
+      auto counts = _mm256_setzero_si256();
+      for ( std::size_t i = 0u; i < padded_size; i += 16u )
       {
-        if ( value < m_cdf_p[ i ] )
-        {
-          break;
-        }
-        ++i;
+        auto c = _mm256_load_si256(
+          reinterpret_cast< __m256i const * >( m_cdf_p + i ) );
+        counts = _mm256_sub_epi16(
+          counts, _mm256_cmpeq_epi16( _mm256_subs_epu16( c, v ),
+                                      _mm256_setzero_si256() ) );
+      }
+      auto sum = _mm_add_epi16( _mm256_castsi256_si128( counts ),
+                                _mm256_extracti128_si256( counts, 1 ) );
+      auto count = horizontal_sum( sum );
+#elif defined( __SSE2__ )
+      auto v = _mm_set1_epi16( static_cast< short >( value ) );
+      auto counts = _mm_setzero_si128();
+      for ( std::size_t i = 0u; i < padded_size; i += 8u )
+      {
+        auto c =
+          _mm_load_si128( reinterpret_cast< __m128i const * >( m_cdf_p + i ) );
+        counts = _mm_sub_epi16(
+          counts,
+          _mm_cmpeq_epi16( _mm_subs_epu16( c, v ), _mm_setzero_si128() ) );
+      }
+      auto count = horizontal_sum( counts );
+#else
+      std::size_t count = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        count += m_cdf_p[ i ] <= value ? 1u : 0u;
       }
-      return static_cast< byte >( i - 1u );
+#endif
+      return static_cast< byte >( count - 1u );
     }
 
-    void display()
+    // adapts table to occurrence of given symbol
+    void update( byte s ) noexcept
+    {
+      // target of C(i) is i below and 2^N - 2^SL + i above symbol; C(i) is
+      //  moved by floored signed shift, which keeps gaps of at least 1; C(0),
+      //  C(2^SL) and padding are at their targets already
+#if defined( __AVX2__ )
+      auto index = _mm256_setr_epi16( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                      12, 13, 14, 15 );
+      auto sym = _mm256_set1_epi16( static_cast< short >( s ) );
+      auto gaps = _mm256_set1_epi16( static_cast< short >( gap ) );
+      auto step = _mm256_set1_epi16( 16 );
+      for ( std::size_t i = 0u; i < padded_size; i += 16u )
+      {
+        auto *c_p = reinterpret_cast< __m256i * >( m_cdf_p + i );
+        auto c = _mm256_load_si256( c_p );
+        auto target = _mm256_add_epi16(
+          index, _mm256_and_si256( _mm256_cmpgt_epi16( index, sym ), gaps ) );
+        c = _mm256_add_epi16(
+          c, _mm256_srai_epi16( _mm256_sub_epi16( target, c ), RATE ) );
+        _mm256_store_si256( c_p, c );
+        index = _mm256_add_epi16( index, step );
+      }
+#elif defined( __SSE2__ )
+      auto index = _mm_setr_epi16( 0, 1, 2, 3, 4, 5, 6, 7 );
+      auto sym = _mm_set1_epi16( static_cast< short >( s ) );
+      auto gaps = _mm_set1_epi16( static_cast< short >( gap ) );
+      auto step = _mm_set1_epi16( 8 );
+      for ( std::size_t i = 0u; i < padded_size; i += 8u )
+      {
+        auto *c_p = reinterpret_cast< __m128i * >( m_cdf_p + i );
+        auto c = _mm_load_si128( c_p );
+        auto target = _mm_add_epi16(
+          index, _mm_and_si128( _mm_cmpgt_epi16( index, sym ), gaps ) );
+        c = _mm_add_epi16( c,
+                           _mm_srai_epi16( _mm_sub_epi16( target, c ), RATE ) );
+        _mm_store_si128( c_p, c );
+        index = _mm_add_epi16( index, step );
+      }
+#else
+      for ( std::size_t i = 1u; i < size(); ++i )
+      {
+        auto target = static_cast< int >( i ) + ( i > s ? gap : 0 );
+        auto value = static_cast< int >( m_cdf_p[ i ] );
+        m_cdf_p[ i ] =
+          static_cast< num_type >( value + ( ( target - value ) >> RATE ) );
+      }
+#endif
+      ++m_symbol_count;
+    }
+
+    void display() const
     {
       std::printf( "Total symbol count:    %5u\n", symbol_count() );
       std::printf( "Numeral system size:   %5u\n", num_base() );
@@ -115,12 +211,6 @@ namespace coding
       }
     }
 
-    template < std::size_t _BufSize >
-    void write_header( bit_buffer< _BufSize > &buf ) noexcept
-    {
-      buf.write( ( size() ) * sizeof( word ), m_cdf_p );
-    }
-
     bool operator==( num_freq_table_adapt const &other ) const noexcept
     {
       for ( std::size_t i = 0u; i < size(); ++i )
@@ -138,16 +228,6 @@ namespace coding
       return !( *this == other );
     }
 
-    template < std::size_t _BufSize >
-    static num_freq_table_adapt
-    read_header_reverse( bit_buffer< _BufSize > &buf )
-    {
-      auto result = num_freq_table_adapt{};
-      buf.read_reverse( size() * sizeof( word ), result.m_cdf_p );
-      result.m_cdf_p[ size() ] = num_base();
-      return result;
-    }
-
     ulong rans_encode_adjust( byte s, ulong x ) const noexcept
     {
       return ( x % static_cast< ulong >( f( s ) ) ) +
@@ -162,68 +242,25 @@ namespace coding
     }
 
   private:
-    void adapt_cdf( std::size_t index, byte symbol,
-                    double history[][ 1u << SL ] )
-    {
-      for ( std::size_t i = 0u; i < size(); ++i )
-      {
-        m_cdf_p[ i ] +=
-          ( ( i > static_cast< std::size_t >( symbol ) ? num_base() : 0u ) -
-            m_cdf_p[ i ] ) >>
-          RATE;
-      }
-      update_prob_hist( index, history );
-
-      init_bits_per_symbol_theory();
-
-      std::printf( "\n===> STEP#%lu (symbol - %02x):\n", index, symbol );
-      display();
-      std::printf( "\n" );
-    }
-
-    void update_prob_hist( std::size_t index, double history[][ 1u << SL ] )
-    {
-      for ( std::size_t i = 0u; i < size(); ++i )
-      {
-        history[ index ][ i ] = p( i );
-      }
-    }
-
-    void init_bits_per_symbol_theory()
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+    static std::size_t horizontal_sum( __m128i counts ) noexcept
     {
-      // cf. Shannon
-      m_bits_per_symbol_theory = 0.0;
-      for ( std::size_t i = 0; i < size(); ++i )
-      {
-        auto pr = p( i );
-        if ( pr != 0.0 )
-        {
-          m_bits_per_symbol_theory -= pr * std::log2( pr );
-        }
-      }
+      counts = _mm_add_epi16( counts, _mm_srli_si128( counts, 8 ) );
+      counts = _mm_add_epi16( counts, _mm_srli_si128( counts, 4 ) );
+      counts = _mm_add_epi16( counts, _mm_srli_si128( counts, 2 ) );
+      return static_cast< std::size_t >( _mm_cvtsi128_si32( counts ) &
+                                         0xffff );
     }
+#endif
 
-    void write_history( char const *path, std::size_t data_size,
-                        double history[][ 1u << SL ] )
-    {
-      auto fout = std::ofstream( path );
+    static constexpr int gap = static_cast< int >( ( 1u << N ) - ( 1u << SL ) );
 
-      for ( std::size_t i = 0u; i < data_size * ( 8u / SL ) + 1u; ++i )
-      {
-        for ( std::size_t j = 0u; j < size(); ++j )
-        {
-          fout << history[ i ][ j ] << "\t";
-        }
-        fout << "\n";
-      }
-
-      fout.close();
-    }
+    // C(0) .. C(2^SL) padded to whole vectors of 16 lanes
+    static constexpr std::size_t padded_size =
+      ( ( 1u << SL ) + 16u ) & ~std::size_t{ 15u };
 
-  private:
-    word m_cdf_p[ ( 1u << SL ) + 1u ] = {};
+    alignas( 32 ) num_type m_cdf_p[ padded_size ] = {};
     uint m_symbol_count = 0u;
-    double m_bits_per_symbol_theory = 0.0;
   };
 
 }  // namespace coding
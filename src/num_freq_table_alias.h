@@ -2,61 +2,171 @@
 #define CODING_NUM_FREQ_TABLE_ALIAS_H_INCLUDED
 
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <tuple>
+#include <type_traits>
+#include <stdexcept>
 #include <utility>
 
 #include "bit_buffer.h"
 #include "data_block.h"
+#include "freq_normalize.h"
+#include "header_codec.h"
+#include "histogram.h"
 
 namespace coding
 {
-  // table storing symbol frequencies for certain data block
+  // table storing symbol frequencies for certain data block, decoded with
+  //  alias method: slot range is split into 2^SL buckets of 2^(N-SL) slots,
+  //  slots of bucket below its divider belong to bucket symbol and the rest
+  //  to its alias; encoder maps ( x mod f(S) ) + C(S) to those slots through
+  //  remap table of 2^N slots or, for larger numeral systems, through runs of
+  //  consecutive slots ( at most two per bucket )
   template < std::size_t SL, std::size_t N >
   class num_freq_table_alias
   {
   public:
-    num_freq_table_alias() noexcept {}
+    static_assert( SL <= 16u && SL <= N && N <= 24u,
+                   "unsupported alias table size" );
+
+    using num_type = num_word< N >;
+    using bias_type = std::make_signed_t< num_type >;
+    using run_index = num_word< SL + 1u >;
+
+    // slots are remapped in O(1) as long as table of 2^N slots stays small
+    //  ( cf. num_freq_table_lookup ), larger numeral systems look up runs
+    static constexpr bool slot_remap = N <= 16u;
+
+    // decoder data of single bucket; part 0 is bucket symbol, part 1 its
+    //  alias, each with f(S) and bias = slot - ( x mod f(S) ); part is
+    //  selected by index, so that decoding does not branch on divider
+    struct alias_entry
+    {
+      num_type divider;
+      sym_word< SL > symbol_p[ 2 ];
+      num_type freq_p[ 2 ];
+      bias_type bias_p[ 2 ];
+    };
+
+    static_assert( SL > 8u || N >= 16u || sizeof( alias_entry ) == 12u,
+                   "alias entry of byte alphabet not packed" );
+
+    constexpr num_freq_table_alias() noexcept {}
+
+    // static model of nonzero frequencies summing to 2^N, cf.
+    //  num_freq_table; alias entries and slot remap are computed with it
+    constexpr explicit num_freq_table_alias(
+      num_type const ( &freqs_p )[ 1u << SL ] )
+    {
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        if ( freqs_p[ i ] == 0u )
+        {
+          throw std::invalid_argument( "static frequencies must be nonzero" );
+        }
+      }
+      init_cdf( freqs_p );
+      if ( static_cast< ulong >( m_cdf_p[ size() ] ) != num_base() )
+      {
+        throw std::invalid_argument( "static frequencies must sum to 2^N" );
+      }
+      construct_alias_table();
+    }
 
     template < std::size_t _BufSize >
     explicit num_freq_table_alias( bit_buffer< _BufSize > &buf )
     {
-      buf.read( size() * sizeof( word ), m_cdf_p );
-      m_cdf_p[ size() ] = num_base();
-      construct_alias_table();
+      assign_header( buf );
     }
 
     template < std::size_t _DataSize >
     explicit num_freq_table_alias( data_block< _DataSize, SL > &data )
+    {
+      assign( data );
+    }
+
+    // symbols of large block counted by threads of pool
+    template < std::size_t _DataSize >
+    num_freq_table_alias( data_block< _DataSize, SL > &data, thread_pool &pool )
     {
       uint freqs[ 1u << SL ] = {};
-      auto cursor_pos = data.get_position();
-      while ( data )
-      {
-        ++freqs[ data.read_symbol() ];
-        ++m_symbol_count;
-      }
-      data.set_position( cursor_pos );
+      m_symbol_count =
+        static_cast< uint >( count_symbols( data, freqs, pool ) );
+      init( freqs );
+    }
+
+    // table of next block built in place; alias entries and slot runs are
+    //  kept when normalized frequencies did not change
+    template < std::size_t _DataSize >
+    void assign( data_block< _DataSize, SL > &data )
+    {
+      uint freqs[ 1u << SL ] = {};
+      m_symbol_count = static_cast< uint >( count_symbols( data, freqs ) );
       init( freqs );
-      m_cdf_p[ size() ] = num_base();
-      construct_alias_table();
     }
 
-    static std::size_t size() noexcept { return 1u << SL; }
+    // same with normalization scratch kept by caller, cf. rans::codec_context
+    template < std::size_t _DataSize >
+    void assign( data_block< _DataSize, SL > &data, normalize_scratch &scratch )
+    {
+      uint freqs[ 1u << SL ] = {};
+      m_symbol_count = static_cast< uint >( count_symbols( data, freqs ) );
+      init( freqs, scratch );
+    }
+
+    // reads header at cursor into table
+    template < std::size_t _BufSize >
+    void assign_header( bit_buffer< _BufSize > &buf )
+    {
+      num_type freqs[ 1u << SL ];
+      read_header_freqs( buf, freqs, size(), num_base() );
+      update( freqs );
+    }
+
+    // reads header ending at cursor into table, cf. assign
+    template < std::size_t _BufSize >
+    void assign_header_reverse( bit_buffer< _BufSize > &buf )
+    {
+      num_type freqs[ 1u << SL ];
+      read_header_freqs_reverse( buf, freqs, size(), num_base() );
+      update( freqs );
+    }
+
+    // reads legacy header ending at cursor into table, cf. header_format
+    template < std::size_t _BufSize >
+    void assign_legacy_header_reverse( bit_buffer< _BufSize > &buf )
+    {
+      num_type freqs[ 1u << SL ];
+      read_legacy_header_freqs_reverse( buf, freqs, size(), num_base() );
+      update( freqs );
+    }
 
-    uint header_length() const noexcept
+    static constexpr std::size_t size() noexcept { return 1u << SL; }
+
+    uint header_length( header_format format = default_header_format ) const
     {
-      return static_cast< uint >( size() * sizeof( word ) ) << 3u;
+      num_type freqs[ 1u << SL ];
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        freqs[ i ] = f( i );
+      }
+      return static_cast< uint >(
+               header_freqs_size( freqs, size(), num_base(), format ) )
+             << 3u;
     }
 
-    static word num_base() noexcept { return 1u << N; }
+    static constexpr num_type num_base() noexcept { return 1u << N; }
 
-    word num_mask() const noexcept { return ( 1u << N ) - 1u; }
+    constexpr num_type num_mask() const noexcept { return ( 1u << N ) - 1u; }
 
-    word cdf( std::size_t index ) const noexcept { return m_cdf_p[ index ]; }
+    constexpr num_type cdf( std::size_t index ) const noexcept
+    {
+      return m_cdf_p[ index ];
+    }
 
-    word f( std::size_t index ) const noexcept
+    constexpr num_type f( std::size_t index ) const noexcept
     {
       return m_cdf_p[ index + 1 ] - m_cdf_p[ index ];
     }
@@ -80,12 +190,10 @@ namespace coding
       return m_bits_per_symbol_theory;
     }
 
-    byte symbol( word value ) const noexcept
+    constexpr sym_word< SL > symbol( num_type value ) const noexcept
     {
-      auto bucket =
-        static_cast< byte >( value >> static_cast< word >( N - SL ) );
-      auto shift = value & ( ( 1u << static_cast< word >( N - SL ) ) - 1u );
-      return shift < m_dividers[ bucket ] ? bucket : m_aliases[ bucket ];
+      auto const &e = m_entries_p[ value >> ( N - SL ) ];
+      return e.symbol_p[ ( value & ( bucket_size() - 1u ) ) >= e.divider ];
     }
 
     void display()
@@ -101,14 +209,31 @@ namespace coding
       {
         std::printf( " %02x %8u %8u %.6f %.6f %8u   %02x\n",
                      static_cast< uint >( i ), f( i ), cdf( i ), p( i ),
-                     p_cdf( i ), m_dividers[ i ], m_aliases[ i ] );
+                     p_cdf( i ), m_entries_p[ i ].divider,
+                     m_entries_p[ i ].symbol_p[ 1 ] );
       }
     }
 
     template < std::size_t _BufSize >
-    void write_header( bit_buffer< _BufSize > &buf ) noexcept
+    void write_header( bit_buffer< _BufSize > &buf,
+                       header_format format = default_header_format ) const
+    {
+      auto writer = detail::header_writer{};
+      write_header( buf, writer, format );
+    }
+
+    // header payload collected in writer reused between calls
+    template < std::size_t _BufSize >
+    void write_header( bit_buffer< _BufSize > &buf,
+                       detail::header_writer &writer,
+                       header_format format = default_header_format ) const
     {
-      buf.write( ( size() ) * sizeof( word ), m_cdf_p );
+      num_type freqs[ 1u << SL ];
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        freqs[ i ] = f( i );
+      }
+      write_header_freqs( buf, writer, freqs, size(), num_base(), format );
     }
 
     bool operator==( num_freq_table_alias const &other ) const noexcept
@@ -133,53 +258,101 @@ namespace coding
     read_header_reverse( bit_buffer< _BufSize > &buf )
     {
       auto result = num_freq_table_alias{};
-      buf.read_reverse( size() * sizeof( word ), result.m_cdf_p );
-      result.m_cdf_p[ size() ] = num_base();
-      result.construct_alias_table();
+      result.assign_header_reverse( buf );
       return result;
     }
 
-    ulong rans_encode_adjust( byte s, ulong x ) const noexcept
+    constexpr ulong rans_encode_adjust( sym_word< SL > s,
+                                        ulong x ) const noexcept
     {
-      return m_alias_remap[ ( x % static_cast< ulong >( f( s ) ) ) +
-                            static_cast< ulong >( cdf( s ) ) ];
+      return rans_encode_slot( ( x % static_cast< ulong >( f( s ) ) ) +
+                               static_cast< ulong >( cdf( s ) ) );
     }
 
-    std::pair< ulong, ulong > adjusted_f_and_cdf( [[maybe_unused]] word s,
-                                                  [[maybe_unused]] ulong value )
+    // maps symbol slot ( x mod f(s) ) + C(s) to its place in coded state;
+    //  without remap table, run holding start of its bucket is looked up,
+    //  then only runs starting later within bucket are stepped over ( mostly
+    //  one at most, slots of frequent symbols lie in runs as long as bucket )
+    constexpr ulong rans_encode_slot( ulong slot ) const noexcept
     {
-      auto bucket =
-        static_cast< ulong >( value >> static_cast< ulong >( N - SL ) );
-      auto shift = value & ( ( 1u << static_cast< ulong >( N - SL ) ) - 1u );
-      auto i = bucket << 1u;
-      if ( shift >= m_dividers[ bucket ] )
+      if constexpr ( slot_remap )
       {
-        i++;
+        return m_remap_p[ slot ];
       }
+      else
+      {
+        std::size_t i = m_bucket_run_p[ slot >> ( N - SL ) ];
+        i += m_run_orig_p[ i + 1u ] <= slot;
+        while ( m_run_orig_p[ i + 1u ] <= slot )
+        {
+          ++i;
+        }
+        return run_slot( i, slot );
+      }
+    }
 
-      return std::make_pair( static_cast< ulong >( m_slot_freq[ i ] ),
-                             static_cast< ulong >( m_slot_csum[ i ] ) );
+    // f(S) and bias of slot, bias may be negative ( wraps around in ulong )
+    constexpr std::pair< ulong, ulong >
+    adjusted_f_and_cdf( [[maybe_unused]] word s, ulong value ) const noexcept
+    {
+      auto const &e = m_entries_p[ value >> ( N - SL ) ];
+      auto part = ( value & ( bucket_size() - 1u ) ) >= e.divider;
+      return std::make_pair(
+        static_cast< ulong >( e.freq_p[ part ] ),
+        static_cast< ulong >( static_cast< long >( e.bias_p[ part ] ) ) );
     }
 
   private:
-    void init( uint *freqs_p ) noexcept
+    constexpr void init_cdf( num_type const *freqs_p ) noexcept
+    {
+      m_cdf_p[ 0 ] = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        m_cdf_p[ i + 1 ] =
+          static_cast< num_type >( m_cdf_p[ i ] + freqs_p[ i ] );
+      }
+    }
+
+    void init( uint *freqs_p )
+    {
+      auto scratch = normalize_scratch{};
+      init( freqs_p, scratch );
+    }
+
+    void init( uint *freqs_p, normalize_scratch &scratch )
     {
       init_bits_per_symbol_theory( freqs_p );
 
-      for ( std::size_t i = 1u; i < size(); ++i )
+      normalize_freqs( freqs_p, size(), num_base(), scratch );
+
+      update( freqs_p );
+    }
+
+    // rebuilds table unless frequencies are those of table ( never true for
+    //  empty one, its frequencies do not sum to 2^N )
+    template < typename T >
+    void update( T const *freqs_p )
+    {
+      std::size_t i = 0u;
+      while ( i < size() && freqs_p[ i ] == f( i ) )
       {
-        freqs_p[ i ] += freqs_p[ i - 1 ];
+        ++i;
+      }
+      if ( i == size() )
+      {
+        return;
       }
 
-      m_cdf_p[ 0 ] = 0u;
-
-      auto fac = static_cast< double >( num_base() ) /
-                 static_cast< double >( symbol_count() );
+      for ( ; i < size(); ++i )
+      {
+        m_cdf_p[ i + 1 ] =
+          static_cast< num_type >( m_cdf_p[ i ] + freqs_p[ i ] );
+      }
 
-      for ( std::size_t i = 1u; i < size(); ++i )
+      // empty block has no symbols to look up
+      if ( m_cdf_p[ size() ] != 0u )
       {
-        m_cdf_p[ i ] = static_cast< word >(
-          static_cast< double >( freqs_p[ i - 1 ] ) * fac );
+        construct_alias_table();
       }
     }
 
@@ -203,34 +376,36 @@ namespace coding
     class bounded_stack
     {
     public:
-      void push( T value ) noexcept { m_data_p[ m_top++ ] = value; }
-      T pop() noexcept { return m_data_p[ --m_top ]; }
-      T top() const noexcept { return m_data_p[ m_top - 1 ]; }
-      std::size_t size() const noexcept { return m_top; }
-      operator bool() const noexcept { return m_top != 0u; }
+      constexpr void push( T value ) noexcept { m_data_p[ m_top++ ] = value; }
+      constexpr T pop() noexcept { return m_data_p[ --m_top ]; }
+      constexpr T top() const noexcept { return m_data_p[ m_top - 1 ]; }
+      constexpr std::size_t size() const noexcept { return m_top; }
+      constexpr operator bool() const noexcept { return m_top != 0u; }
 
     private:
       std::size_t m_top = 0u;
       T m_data_p[ M ] = {};
     };
 
-    using bstack = bounded_stack< byte, 1u << SL >;
+    using bstack = bounded_stack< sym_word< SL >, 1u << SL >;
 
-    void construct_alias_table()
+    constexpr void construct_alias_table()
     {
       auto large = bstack{};
       auto small = bstack{};
+      num_type dividers[ 1u << SL ] = {};
+      sym_word< SL > aliases[ 1u << SL ] = {};
 
       for ( std::size_t i = 0u; i < size(); ++i )
       {
-        m_dividers[ i ] = f( i );
-        if ( m_dividers[ i ] > bucket_size() )
+        dividers[ i ] = f( i );
+        if ( dividers[ i ] > bucket_size() )
         {
-          large.push( static_cast< byte >( i ) );
+          large.push( static_cast< sym_word< SL > >( i ) );
         }
         else
         {
-          small.push( static_cast< byte >( i ) );
+          small.push( static_cast< sym_word< SL > >( i ) );
         }
       }
 
@@ -239,10 +414,11 @@ namespace coding
         auto sm = small.pop();
         auto lg = large.pop();
 
-        m_aliases[ sm ] = lg;
-        m_dividers[ lg ] -= bucket_size() - m_dividers[ sm ];
+        aliases[ sm ] = lg;
+        dividers[ lg ] = static_cast< num_type >(
+          dividers[ lg ] - bucket_size() + dividers[ sm ] );
 
-        if ( m_dividers[ lg ] < bucket_size() )
+        if ( dividers[ lg ] < bucket_size() )
         {
           small.push( lg );
         }
@@ -251,50 +427,62 @@ namespace coding
           large.push( lg );
         }
       }
-      assert_alias();
-      construct_alias_remap();
+      assert_alias( dividers, aliases );
+      if constexpr ( !slot_remap )
+      {
+        count_alias_runs( dividers, aliases );
+      }
+      construct_alias_remap( dividers, aliases );
     }
 
-    void construct_alias_remap() noexcept
+    // runs of every symbol are stored together, in order of its slots
+    constexpr void count_alias_runs( num_type const *dividers_p,
+                                     sym_word< SL > const *aliases_p )
     {
-      word used[ 1u << SL ] = {};
-      // for (std::size_t i = 0u; i < size(); ++i)
-      //{
-      //  remaining[i] = f(i);
-      //}
-
+      for ( std::size_t i = 0u; i <= size(); ++i )
+      {
+        m_first_run_p[ i ] = 0u;
+      }
       for ( std::size_t i = 0u; i < size(); ++i )
       {
-        // initial bucket symbols
-        auto orig_curr = cdf( i ) + used[ i ];
-        auto alias_beg =
-          static_cast< word >( bucket_size() * static_cast< word >( i ) );
-        auto count = m_dividers[ i ];
-        m_slot_freq[ ( i << 1u ) + 0u ] = f( i );
-        m_slot_csum[ ( i << 1u ) + 0u ] = alias_beg + used[ i ];
-        used[ i ] += count;
-        auto alias_end = static_cast< word >( alias_beg + count );
-
-        while ( alias_beg < alias_end )
+        if ( dividers_p[ i ] > 0u )
         {
-          m_alias_remap[ orig_curr++ ] = alias_beg++;
+          ++m_first_run_p[ i + 1u ];
         }
-
-        // aliased bucket symbols
-        auto j = m_aliases[ i ];
-        orig_curr = cdf( j ) + used[ j ];
-        alias_beg = alias_end;
-        count = bucket_size() - count;
-        m_slot_freq[ ( i << 1u ) + 0u ] = f( j );
-        m_slot_csum[ ( i << 1u ) + 0u ] = alias_beg + used[ j ];
-        used[ j ] += count;
-        alias_end = alias_beg + count;
-
-        while ( alias_beg < alias_end )
+        if ( dividers_p[ i ] < bucket_size() )
         {
-          m_alias_remap[ orig_curr++ ] = alias_beg++;
+          ++m_first_run_p[ aliases_p[ i ] + 1u ];
         }
       }
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        m_first_run_p[ i + 1u ] = static_cast< run_index >(
+          m_first_run_p[ i + 1u ] + m_first_run_p[ i ] );
+      }
+    }
+
+    constexpr void construct_alias_remap( num_type const *dividers_p,
+                                          sym_word< SL > const *aliases_p )
+    {
+      num_type used[ 1u << SL ] = {};
+      run_index runs[ 1u << SL ] = {};
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        auto &e = m_entries_p[ i ];
+        e.divider = dividers_p[ i ];
+        e.symbol_p[ 0 ] = static_cast< sym_word< SL > >( i );
+        e.symbol_p[ 1 ] = aliases_p[ i ];
+
+        // initial bucket symbols, then aliased bucket symbols
+        auto beg = static_cast< num_type >( bucket_size() * i );
+        assign_slots( e, 0u, static_cast< sym_word< SL > >( i ), beg,
+                      dividers_p[ i ], used, runs );
+        assign_slots( e, 1u, aliases_p[ i ],
+                      static_cast< num_type >( beg + dividers_p[ i ] ),
+                      static_cast< num_type >( bucket_size() -
+                                               dividers_p[ i ] ),
+                      used, runs );
+      }
 
       // check correctness
       for ( std::size_t i = 0u; i < size(); ++i )
@@ -304,20 +492,77 @@ namespace coding
           std::printf( "Invalid alias remap table!" );
         }
       }
+
+      if constexpr ( !slot_remap )
+      {
+        index_bucket_runs();
+      }
     }
 
-    word bucket_size() const noexcept
+    // runs of symbols follow one another in order of symbol slots, last one
+    //  is followed by end of slots
+    constexpr void index_bucket_runs()
     {
-      return static_cast< word >( 1u << ( N - SL ) );
+      auto run_count = static_cast< std::size_t >( m_first_run_p[ size() ] );
+      m_run_orig_p[ run_count ] = num_base();
+      std::size_t run = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        while ( m_run_orig_p[ run + 1u ] <= bucket_size() * i )
+        {
+          ++run;
+        }
+        m_bucket_run_p[ i ] = static_cast< run_index >( run );
+      }
     }
 
-    void assert_alias()
+    // assigns count slots starting at beg to next occurrences of symbol
+    constexpr void assign_slots( alias_entry &e, std::size_t part,
+                                 sym_word< SL > s, num_type beg,
+                                 num_type count, num_type *used_p,
+                                 run_index *runs_p ) noexcept
     {
-      word freqs[ 1u << SL ] = {};
+      e.freq_p[ part ] = f( s );
+      e.bias_p[ part ] = static_cast< bias_type >(
+        static_cast< long >( beg ) - static_cast< long >( used_p[ s ] ) );
+      if constexpr ( slot_remap )
+      {
+        auto orig = cdf( s ) + used_p[ s ];
+        for ( std::size_t k = 0u; k < count; ++k )
+        {
+          m_remap_p[ orig + k ] = static_cast< num_type >( beg + k );
+        }
+      }
+      else if ( count > 0u )
+      {
+        auto i = m_first_run_p[ s ] + runs_p[ s ];
+        m_run_orig_p[ i ] = static_cast< num_type >( cdf( s ) + used_p[ s ] );
+        m_run_slot_p[ i ] = beg;
+        runs_p[ s ] = static_cast< run_index >( runs_p[ s ] + 1u );
+      }
+      used_p[ s ] = static_cast< num_type >( used_p[ s ] + count );
+    }
+
+    constexpr ulong run_slot( std::size_t i, ulong slot ) const noexcept
+    {
+      return static_cast< ulong >( m_run_slot_p[ i ] ) + slot -
+             static_cast< ulong >( m_run_orig_p[ i ] );
+    }
+
+    static constexpr num_type bucket_size() noexcept
+    {
+      return static_cast< num_type >( 1u << ( N - SL ) );
+    }
+
+    constexpr void assert_alias( num_type const *dividers_p,
+                                 sym_word< SL > const *aliases_p )
+    {
+      num_type freqs[ 1u << SL ] = {};
       for ( std::size_t i = 0u; i < size(); ++i )
       {
-        freqs[ i ] += m_dividers[ i ];
-        freqs[ m_aliases[ i ] ] += bucket_size() - m_dividers[ i ];
+        freqs[ i ] = static_cast< num_type >( freqs[ i ] + dividers_p[ i ] );
+        freqs[ aliases_p[ i ] ] = static_cast< num_type >(
+          freqs[ aliases_p[ i ] ] + bucket_size() - dividers_p[ i ] );
       }
       for ( std::size_t i = 0u; i < size(); ++i )
       {
@@ -329,15 +574,23 @@ namespace coding
     }
 
   private:
-    word m_cdf_p[ ( 1u << SL ) + 1u ] = {};
+    num_type m_cdf_p[ ( 1u << SL ) + 1u ] = {};
     uint m_symbol_count = 0u;
     double m_bits_per_symbol_theory = 0.0;
 
-    word m_dividers[ 1u << SL ] = {};
-    byte m_aliases[ 1u << SL ] = {};
-    word m_alias_remap[ 1u << N ] = {};
-    word m_slot_freq[ 1u << ( SL + 1u ) ] = {};
-    word m_slot_csum[ 1u << ( SL + 1u ) ] = {};
+    alias_entry m_entries_p[ 1u << SL ] = {};
+
+    // used by encoder only; either place of every symbol slot, or runs in
+    //  order of symbol slots, each with its first symbol slot and first alias
+    //  slot, and run holding first symbol slot of every bucket
+    static constexpr std::size_t remap_size = slot_remap ? 1u << N : 1u;
+    static constexpr std::size_t run_table_size = slot_remap ? 1u : 1u << SL;
+
+    num_type m_remap_p[ remap_size ] = {};
+    run_index m_first_run_p[ run_table_size + 1u ] = {};
+    num_type m_run_orig_p[ 2u * run_table_size + 1u ] = {};
+    num_type m_run_slot_p[ 2u * run_table_size ] = {};
+    run_index m_bucket_run_p[ run_table_size ] = {};
   };
 
 }  // namespace coding
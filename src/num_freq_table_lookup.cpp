@@ -0,0 +1,5 @@
+#include "num_freq_table_lookup.h"
+
+namespace coding
+{
+}  // namespace coding
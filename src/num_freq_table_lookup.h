@@ -0,0 +1,97 @@
+#ifndef CODING_NUM_FREQ_TABLE_LOOKUP_H_INCLUDED
+#define CODING_NUM_FREQ_TABLE_LOOKUP_H_INCLUDED
+
+#include <utility>
+
+#include "num_freq_table.h"
+
+namespace coding
+{
+  // decoder data of single N-bit slot ( x mod 2^N ) of SL-bit symbols
+  template < std::size_t SL >
+  struct rans_dec_slot
+  {
+    word freq;              // f(s)
+    word cdf;               // C(s)
+    sym_word< SL > symbol;  // s
+  };
+
+  // numeral frequency table with O(1) slot to symbol lookup for decoding;
+  //  header format is the same as for num_freq_table
+  template < std::size_t SL, std::size_t N >
+  class num_freq_table_lookup : public num_freq_table< SL, N >
+  {
+  public:
+    static_assert( N <= 15u, "slot entries store 16-bit frequencies" );
+
+    using base_type = num_freq_table< SL, N >;
+
+    num_freq_table_lookup() noexcept {}
+
+    explicit num_freq_table_lookup( base_type const &ft ) : base_type( ft )
+    {
+      init_slots();
+    }
+
+    template < std::size_t _BufSize >
+    explicit num_freq_table_lookup( bit_buffer< _BufSize > &buf ) :
+      base_type( buf )
+    {
+      init_slots();
+    }
+
+    template < std::size_t _DataSize >
+    explicit num_freq_table_lookup( data_block< _DataSize, SL > &data ) :
+      base_type( data )
+    {
+      init_slots();
+    }
+
+    rans_dec_slot< SL > const &slot( word value ) const noexcept
+    {
+      return m_slots_p[ value ];
+    }
+
+    sym_word< SL > symbol( word value ) const noexcept
+    {
+      return m_slots_p[ value ].symbol;
+    }
+
+    std::pair< ulong, ulong > adjusted_f_and_cdf( [[maybe_unused]] word s,
+                                                  ulong value ) const noexcept
+    {
+      auto const &e = m_slots_p[ value ];
+      return std::make_pair( static_cast< ulong >( e.freq ),
+                             static_cast< ulong >( e.cdf ) );
+    }
+
+    template < std::size_t _BufSize >
+    static num_freq_table_lookup
+    read_header_reverse( bit_buffer< _BufSize > &buf )
+    {
+      return num_freq_table_lookup( base_type::read_header_reverse( buf ) );
+    }
+
+  private:
+    void init_slots() noexcept
+    {
+      for ( std::size_t i = 0u; i < base_type::size(); ++i )
+      {
+        auto e = rans_dec_slot< SL >{ this->f( i ), this->cdf( i ),
+                                      static_cast< sym_word< SL > >( i ) };
+        auto end = static_cast< std::size_t >( this->cdf( i ) ) +
+                   static_cast< std::size_t >( e.freq );
+        for ( std::size_t j = this->cdf( i ); j < end; ++j )
+        {
+          m_slots_p[ j ] = e;
+        }
+      }
+    }
+
+  private:
+    rans_dec_slot< SL > m_slots_p[ 1u << N ] = {};
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_NUM_FREQ_TABLE_LOOKUP_H_INCLUDED
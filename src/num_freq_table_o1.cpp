@@ -0,0 +1,5 @@
+#include "num_freq_table_o1.h"
+
+namespace coding
+{
+}  // namespace coding
@@ -0,0 +1,221 @@
+#ifndef CODING_NUM_FREQ_TABLE_O1_H_INCLUDED
+#define CODING_NUM_FREQ_TABLE_O1_H_INCLUDED
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "data_block.h"
+#include "freq_normalize.h"
+#include "header_codec.h"
+
+namespace coding
+{
+  // order-1 table storing one normalized distribution of symbol frequencies
+  //  per preceding symbol ( context ), first symbol of block is taken in
+  //  context 0; C(S) rows of contexts lie one after another, so that coding
+  //  a symbol touches single row ( 2^SL + 1 entries of num_type ); smaller
+  //  N gives both smaller rows and smaller header
+  template < std::size_t SL, std::size_t N >
+  class num_freq_table_o1
+  {
+  public:
+    static_assert( SL <= 8u, "order-1 tables support up to 256 contexts" );
+
+    using num_type = num_word< N >;
+
+    num_freq_table_o1() : m_cdf_p( context_count() * row_size() ) {}
+
+    template < std::size_t _BufSize >
+    explicit num_freq_table_o1( bit_buffer< _BufSize > &buf ) :
+      num_freq_table_o1()
+    {
+      auto freqs = std::vector< num_type >( context_count() * size() );
+      read_header_tables( buf, freqs.data(), context_count(), size(),
+                          num_base() );
+      for ( std::size_t ctx = 0u; ctx < context_count(); ++ctx )
+      {
+        init_row( ctx, freqs.data() + ctx * size() );
+      }
+    }
+
+    template < std::size_t _DataSize >
+    explicit num_freq_table_o1( data_block< _DataSize, SL > &data ) :
+      num_freq_table_o1()
+    {
+      auto counts = std::vector< uint >( context_count() * size() );
+      auto cursor_pos = data.get_position();
+      std::size_t prev = 0u;
+      while ( data )
+      {
+        auto s = static_cast< std::size_t >( data.read_symbol() );
+        ++counts[ prev * size() + s ];
+        prev = s;
+        ++m_symbol_count;
+      }
+      data.set_position( cursor_pos );
+
+      init_bits_per_symbol_theory( counts.data() );
+      for ( std::size_t ctx = 0u; ctx < context_count(); ++ctx )
+      {
+        auto *row_p = counts.data() + ctx * size();
+        normalize_freqs( row_p, size(), num_base() );
+        init_row( ctx, row_p );
+      }
+    }
+
+    static std::size_t size() noexcept { return 1u << SL; }
+
+    static std::size_t context_count() noexcept { return 1u << SL; }
+
+    // header is measured without being written, but frequencies of all
+    //  contexts are still collected on heap
+    uint header_length( header_format format = default_header_format ) const
+    {
+      auto freqs = context_freqs();
+      return static_cast< uint >( header_tables_size(
+               freqs.data(), context_count(), size(), num_base(), format ) )
+             << 3u;
+    }
+
+    static num_type num_base() noexcept { return 1u << N; }
+
+    num_type num_mask() const noexcept { return ( 1u << N ) - 1u; }
+
+    num_type cdf( std::size_t ctx, std::size_t index ) const noexcept
+    {
+      return m_cdf_p[ ctx * row_size() + index ];
+    }
+
+    num_type f( std::size_t ctx, std::size_t index ) const noexcept
+    {
+      auto const *row_p = m_cdf_p.data() + ctx * row_size();
+      return row_p[ index + 1 ] - row_p[ index ];
+    }
+
+    uint symbol_count() const noexcept { return m_symbol_count; }
+
+    // conditional entropy given preceding symbol
+    double bits_per_symbol_theory() const noexcept
+    {
+      return m_bits_per_symbol_theory;
+    }
+
+    byte symbol( std::size_t ctx, num_type value ) const noexcept
+    {
+      // branchless binary search within row of context
+      auto const *row_p = m_cdf_p.data() + ctx * row_size();
+      std::size_t i = 0u;
+      for ( std::size_t n = size(); n > 1u; n -= n >> 1u )
+      {
+        auto half = n >> 1u;
+        i = row_p[ i + half ] <= value ? i + half : i;
+      }
+      return static_cast< byte >( i );
+    }
+
+    void display() const
+    {
+      std::printf( "Total symbol count:    %5u\n", symbol_count() );
+      std::printf( "Numeral system size:   %5u\n", num_base() );
+      std::printf( "Bits/symbol (Shannon): %10.4f\n",
+                   bits_per_symbol_theory() );
+      std::printf( " C  S    f(C,S)   C(C,S)\n" );
+      for ( std::size_t ctx = 0u; ctx < context_count(); ++ctx )
+      {
+        for ( std::size_t i = 0; i < size(); ++i )
+        {
+          if ( f( ctx, i ) != 0u )
+          {
+            std::printf( " %02x %02x %8u %8u\n", static_cast< uint >( ctx ),
+                         static_cast< uint >( i ), f( ctx, i ),
+                         cdf( ctx, i ) );
+          }
+        }
+      }
+    }
+
+    template < std::size_t _BufSize >
+    void write_header( bit_buffer< _BufSize > &buf,
+                       header_format format = default_header_format ) const
+    {
+      auto freqs = context_freqs();
+      write_header_tables( buf, freqs.data(), context_count(), size(),
+                           num_base(), format );
+    }
+
+    bool operator==( num_freq_table_o1 const &other ) const noexcept
+    {
+      return m_cdf_p == other.m_cdf_p;
+    }
+
+    bool operator!=( num_freq_table_o1 const &other ) const noexcept
+    {
+      return !( *this == other );
+    }
+
+  private:
+    static std::size_t row_size() noexcept { return size() + 1u; }
+
+    // frequencies of all contexts, one row after another
+    std::vector< num_type > context_freqs() const
+    {
+      auto freqs = std::vector< num_type >( context_count() * size() );
+      for ( std::size_t ctx = 0u; ctx < context_count(); ++ctx )
+      {
+        for ( std::size_t i = 0u; i < size(); ++i )
+        {
+          freqs[ ctx * size() + i ] = f( ctx, i );
+        }
+      }
+      return freqs;
+    }
+
+    // contexts never seen keep all-zero row
+    template < typename T >
+    void init_row( std::size_t ctx, T const *freqs_p ) noexcept
+    {
+      auto *row_p = m_cdf_p.data() + ctx * row_size();
+      row_p[ 0 ] = 0u;
+      for ( std::size_t i = 0u; i < size(); ++i )
+      {
+        row_p[ i + 1 ] = static_cast< num_type >( row_p[ i ] + freqs_p[ i ] );
+      }
+    }
+
+    void init_bits_per_symbol_theory( uint const *counts_p )
+    {
+      // cf. Shannon, weighted by context probabilities
+      m_bits_per_symbol_theory = 0.0;
+      for ( std::size_t ctx = 0u; ctx < context_count(); ++ctx )
+      {
+        auto const *row_p = counts_p + ctx * size();
+        ulong total = 0u;
+        for ( std::size_t i = 0u; i < size(); ++i )
+        {
+          total += row_p[ i ];
+        }
+        for ( std::size_t i = 0u; i < size(); ++i )
+        {
+          if ( row_p[ i ] != 0u )
+          {
+            auto pr = static_cast< double >( row_p[ i ] ) /
+                      static_cast< double >( total );
+            m_bits_per_symbol_theory -=
+              static_cast< double >( row_p[ i ] ) /
+              static_cast< double >( m_symbol_count ) * std::log2( pr );
+          }
+        }
+      }
+    }
+
+  private:
+    std::vector< num_type > m_cdf_p;
+    uint m_symbol_count = 0u;
+    double m_bits_per_symbol_theory = 0.0;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_NUM_FREQ_TABLE_O1_H_INCLUDED
@@ -1,18 +1,166 @@
 #ifndef CODING_RANS_H_INCLUDED
 #define CODING_RANS_H_INCLUDED
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
 
 #include "bit_buffer.h"
 #include "compr_stats.h"
 #include "data_block.h"
+#include "model_file.h"
+#include "num_enc_table.h"
+#include "word_io.h"
 
 namespace coding::rans
 {
 
+  // state and renormalization policies of encode/decode; state x is kept in
+  //  [ 2^lower_bound_bits, 2^( lower_bound_bits + word_bits ) ) and moved by
+  //  word_bits at a time
+
+  // 32-bit state with 16-bit renormalization, numeral base up to 15 bits
+  struct rans32
+  {
+    using word_type = word;
+    static constexpr ulong word_bits = 16ul;
+    static constexpr ulong lower_bound_bits = 16ul;
+    static constexpr std::size_t max_num_base = 15u;
+  };
+
+  // 64-bit state with 32-bit renormalization, numeral base up to 31 bits
+  struct rans64
+  {
+    using word_type = uint;
+    static constexpr ulong word_bits = 32ul;
+    static constexpr ulong lower_bound_bits = 31ul;
+    static constexpr std::size_t max_num_base = 31u;
+  };
+
+  namespace detail
+  {
+    // codes symbols from cursor of src to end of whole bytes and flushes
+    //  final state; state starts at 0 ( legacy format ) or, for streams that
+    //  carry no symbol count, at lower bound L, since symbols of slot 0 would
+    //  leave state 0 unchanged and could not be told from missing ones
+    template < std::size_t _NumBase, typename _Policy,
+               bool _FromLowerBound = false, typename _Table,
+               std::size_t _BufSize, std::size_t _DataSize,
+               std::size_t _SymLen >
+    void encode_symbols( _Table const &ft,
+                         data_block< _DataSize, _SymLen > &src,
+                         bit_buffer< _BufSize > &dst )
+    {
+      static_assert( _NumBase <= _Policy::max_num_base,
+                     "numeral base too large for state policy" );
+      using word_type = typename _Policy::word_type;
+
+      const ulong MASK = ( 1ul << _Policy::word_bits ) - 1ul;
+      ulong d = _Policy::lower_bound_bits + _Policy::word_bits - _NumBase;
+      ulong x = _FromLowerBound ? 1ul << _Policy::lower_bound_bits : 0ul;
+      auto out = word_writer< _BufSize, word_type >( dst );
+
+      sym_word< _SymLen > span_p[ unpacked_span_size ];
+      for ( auto left = src.symbols_left(); left > 0u; )
+      {
+        auto k = std::min( left, unpacked_span_size );
+        src.read_symbols( span_p, k );
+        left -= k;
+        for ( std::size_t j = 0u; j < k; ++j )
+        {
+          auto s = span_p[ j ];
+          if ( x >= ( static_cast< ulong >( ft.f( s ) ) << d ) )
+          {
+            out.write_value( static_cast< word_type >( x & MASK ) );
+            x >>= _Policy::word_bits;
+          }
+          // x = ( ( x / f ) << _NumBase ) + ( x % f ) +
+          //    static_cast< ulong >( ft.cdf( s ) );
+          x = ( ( x / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
+              ft.rans_encode_adjust( s, x );
+        }
+      }
+
+      while ( x > 0 )
+      {
+        out.write_value( static_cast< word_type >( x & MASK ) );
+        x >>= _Policy::word_bits;
+      }
+      out.flush();
+    }
+
+    // decodes words before cursor of src into block prepared for reverse
+    //  writing, until state is back at its initial value ( cf. encode_symbols )
+    template < std::size_t _NumBase, typename _Policy,
+               bool _FromLowerBound = false, typename _Table,
+               std::size_t _BufSize, std::size_t _DataSize,
+               std::size_t _SymLen >
+    void decode_symbols( _Table const &ft, bit_buffer< _BufSize > &src,
+                         data_block< _DataSize, _SymLen > &dst )
+    {
+      static_assert( _NumBase <= _Policy::max_num_base,
+                     "numeral base too large for state policy" );
+      using word_type = typename _Policy::word_type;
+      const ulong L = 1ul << _Policy::lower_bound_bits;
+      const ulong x_init = _FromLowerBound ? L : 0ul;
+
+      using num_type = decltype( ft.num_mask() );
+      auto mask = static_cast< ulong >( ft.num_mask() );
+      ulong x = 0ul;
+      auto in = word_reader_reverse< _BufSize, word_type >( src );
+
+      // final state was flushed whole, below lower bound only for short input
+      while ( x < L && !in.is_beg() )
+      {
+        x = ( x << _Policy::word_bits ) +
+            static_cast< ulong >( in.read_value_reverse() );
+      }
+
+      // symbols come last to first, so that span is filled from its end
+      sym_word< _SymLen > span_p[ unpacked_span_size ];
+      auto fill = unpacked_span_size;
+
+      while ( !in.is_beg() )
+      {
+        auto s = ft.symbol( static_cast< num_type >( x & mask ) );
+        span_p[ --fill ] = s;
+        if ( fill == 0u )
+        {
+          dst.write_symbols_reverse( span_p, unpacked_span_size );
+          fill = unpacked_span_size;
+        }
+        auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, x & mask );
+        // x = ( ft.f( s ) * ( x >> _NumBase ) ) + ( x & mask ) - ft.cdf( s );
+        x = ( f * ( x >> _NumBase ) ) + ( x & mask ) - cdf;
+        if ( x < L )
+        {
+          x = ( x << _Policy::word_bits ) +
+              static_cast< ulong >( in.read_value_reverse() );
+        }
+      }
+      in.release();
+
+      while ( x != x_init )
+      {
+        auto s = ft.symbol( static_cast< num_type >( x & mask ) );
+        span_p[ --fill ] = s;
+        if ( fill == 0u )
+        {
+          dst.write_symbols_reverse( span_p, unpacked_span_size );
+          fill = unpacked_span_size;
+        }
+        auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, x & mask );
+        x = ( f * ( x >> _NumBase ) ) + ( x & mask ) - cdf;
+      }
+      dst.write_symbols_reverse( span_p + fill, unpacked_span_size - fill );
+    }
+  }  // namespace detail
+
   template < std::size_t _NumBase,
              template < std::size_t, std::size_t > class _FreqTable,
-             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
   compr_stats< _SymLen > encode( data_block< _DataSize, _SymLen > &src,
                                  bit_buffer< _BufSize > &dst )
   {
@@ -27,29 +175,77 @@ namespace coding::rans
 
     // ---------------
 
+    detail::encode_symbols< _NumBase, _Policy >( ft, src, dst );
+
+    ft.write_header( dst );
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats
+    stats.set_header_length( ft.header_length() );
+    stats.set_symbol_count( ft.symbol_count() );
+    stats.set_bits_per_symbol_theory( ft.bits_per_symbol_theory() );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  // division-free variant of encode with bit-identical output; x / f(s)
+  //  and x % f(s) are computed from precomputed per-symbol reciprocals
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen > encode_rcp( data_block< _DataSize, _SymLen > &src,
+                                     bit_buffer< _BufSize > &dst )
+  {
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // compute frequency and encoder tables from data block
+    auto ft = _FreqTable< _SymLen, _NumBase >( src );
+    auto et = num_enc_table< _SymLen, _NumBase >( ft );
+    src.rewind();
+
+    // ---------------
+
     const ulong MASK = ( 1ul << 16ul ) - 1ul;
-    ulong d = 32 - _NumBase;
     ulong x = 0ul;
+    auto out = word_writer< _BufSize, word >( dst );
 
-    while ( src )
+    sym_word< _SymLen > span_p[ unpacked_span_size ];
+    for ( auto left = src.symbols_left(); left > 0u; )
     {
-      auto s = static_cast< ulong >( src.read_symbol() );
-      if ( x >= ( static_cast< ulong >( ft.f( s ) ) << d ) )
+      auto k = std::min( left, unpacked_span_size );
+      src.read_symbols( span_p, k );
+      left -= k;
+      for ( std::size_t j = 0u; j < k; ++j )
       {
-        dst.write_word( static_cast< word >( x & MASK ) );
-        x >>= 16ul;
+        auto const &e = et[ span_p[ j ] ];
+        if ( x >= static_cast< ulong >( e.x_max ) )
+        {
+          out.write_value( static_cast< word >( x & MASK ) );
+          x >>= 16ul;
+        }
+        auto q = e.quotient( x );
+        x = ( q << _NumBase ) +
+            ft.rans_encode_slot( x - q * static_cast< ulong >( e.freq ) +
+                                 static_cast< ulong >( e.bias ) );
       }
-      // x = ( ( x / f ) << _NumBase ) + ( x % f ) +
-      //    static_cast< ulong >( ft.cdf( s ) );
-      x = ( ( x / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
-          ft.rans_encode_adjust( static_cast< byte >( s ), x );
     }
 
     while ( x > 0 )
     {
-      dst.write_word( static_cast< word >( x & MASK ) );
+      out.write_value( static_cast< word >( x & MASK ) );
       x >>= 16ul;
     }
+    out.flush();
 
     ft.write_header( dst );
 
@@ -71,7 +267,8 @@ namespace coding::rans
 
   template < std::size_t _NumBase,
              template < std::size_t, std::size_t > class _FreqTable,
-             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
   std::chrono::nanoseconds decode( bit_buffer< _BufSize > &src,
                                    data_block< _DataSize, _SymLen > &dst )
   {
@@ -83,43 +280,146 @@ namespace coding::rans
 
     // ---------------
 
-    auto mask = static_cast< ulong >( ft.num_mask() );
-    ulong x = 0ul;
+    detail::decode_symbols< _NumBase, _Policy >( ft, src, dst );
 
-    while ( x < ft.num_base() )
-    {
-      x = ( x << 16ul ) + static_cast< ulong >( src.read_word_reverse() );
-    }
+    // ---------------
 
-    while ( !src.is_beg() )
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+  // decodes stream written before header formats were introduced, whose
+  //  table header is raw dump of C(S) ( cf. header_format ); coded symbols
+  //  are same as those of decode
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds decode_legacy( bit_buffer< _BufSize > &src,
+                                          data_block< _DataSize, _SymLen > &dst )
+  {
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    auto ft = _FreqTable< _SymLen, _NumBase >{};
+    ft.assign_legacy_header_reverse( src );
+    detail::decode_symbols< _NumBase, rans32 >( ft, src, dst );
+
+    // end decoding
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+  }
+
+
+  // header-less variants with static model known to both sides ( e.g. built
+  //  in constant expression ); stream holds renormalization words only, state
+  //  starts at lower bound, so that end of symbols is told by state alone
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode( _FreqTable< _SymLen, _NumBase > const &model,
+          data_block< _DataSize, _SymLen > &src, bit_buffer< _BufSize > &dst )
+  {
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    src.rewind();
+    auto count = src.symbols_left();
+    detail::encode_symbols< _NumBase, _Policy, true >( model, src, dst );
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // entropy of model stands for that of data
+    auto bits_per_symbol = 0.0;
+    for ( std::size_t i = 0u; i < model.size(); ++i )
     {
-      auto s = ft.symbol( static_cast< word >( x & mask ) );
-      dst.write_symbol_reverse( s );
-      auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, x & mask );
-      // x = ( ft.f( s ) * ( x >> _NumBase ) ) + ( x & mask ) - ft.cdf( s );
-      x = ( f * ( x >> _NumBase ) ) + ( x & mask ) - cdf;
-      if ( x < ( 1ul << 16ul ) )
+      if ( model.f( i ) != 0u )
       {
-        x = ( x << 16ul ) + static_cast< ulong >( src.read_word_reverse() );
+        bits_per_symbol -= model.p( i ) * std::log2( model.p( i ) );
       }
     }
 
-    while ( x > 0 )
-    {
-      auto s = ft.symbol( static_cast< word >( x & mask ) );
-      dst.write_symbol_reverse( s );
-      x = ( ft.f( s ) * ( x >> _NumBase ) ) + ( x & mask ) - ft.cdf( s );
-    }
+    // write current run stats
+    stats.set_symbol_count( static_cast< ulong >( count ) );
+    stats.set_bits_per_symbol_theory( bits_per_symbol );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
 
-    // ---------------
+    return stats;
+  }
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode( _FreqTable< _SymLen, _NumBase > const &model,
+          bit_buffer< _BufSize > &src, data_block< _DataSize, _SymLen > &dst )
+  {
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    detail::decode_symbols< _NumBase, _Policy, true >( model, src, dst );
 
     // end decoding
-    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
       std::chrono::high_resolution_clock::now() - start_time );
+  }
 
-    return decoding_time;
+  // variants with trained model of set ( cf. model_file.h ); stream is that
+  //  of static model followed by symbol count and model id in 7-bit groups,
+  //  readable from end, so that decoder prepares dst itself
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode( model_set< _SymLen, _NumBase, _FreqTable > const &models, uint id,
+          data_block< _DataSize, _SymLen > &src, bit_buffer< _BufSize > &dst )
+  {
+    auto stats =
+      encode< _NumBase, _FreqTable, _Policy >( models.find( id ), src, dst );
+    auto length = dst.length();
+    coding::detail::write_length(
+      dst, static_cast< std::size_t >( stats.symbol_count() ) );
+    coding::detail::write_length( dst, id );
+
+    // symbol count and model id stand for header
+    stats.set_header_length( dst.length() - length );
+    stats.set_encoded_length( dst.length() );
+
+    return stats;
   }
 
+  // throws std::out_of_range if model of stream is not in set
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             typename _Policy = rans32, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode( model_set< _SymLen, _NumBase, _FreqTable > const &models,
+          bit_buffer< _BufSize > &src, data_block< _DataSize, _SymLen > &dst )
+  {
+    auto id = static_cast< uint >( coding::detail::read_length_reverse( src ) );
+    auto const &model = models.find( id );
+    auto count = coding::detail::read_length_reverse( src );
+    if ( !dst.prepare( count ) )
+    {
+      std::printf( "Decoded block too small for %lu symbols.\n", count );
+      return std::chrono::nanoseconds{};
+    }
+    return decode< _NumBase, _FreqTable, _Policy >( model, src, dst );
+  }
 
   // VARIANTS WITH VERBOSE MODE OPTION
 
@@ -178,7 +478,7 @@ namespace coding::rans
       // x = ( ( x / f ) << _NumBase ) + ( x % f ) +
       //    static_cast< ulong >( ft.cdf( s ) );
       x = ( ( x / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
-          ft.rans_encode_adjust( static_cast< byte >( s ), x );
+          ft.rans_encode_adjust( static_cast< sym_word< _SymLen > >( s ), x );
       if ( verbose )
       {
         std::printf( "%lu\n", x );
@@ -253,7 +553,7 @@ namespace coding::rans
     ulong x = 0ul;
 
 
-    while ( x < ft.num_base() )
+    while ( x < ( 1ul << 16ul ) && !src.is_beg() )
     {
       auto new_word = static_cast< ulong >( src.read_word_reverse() );
       if ( verbose )
@@ -323,7 +623,8 @@ namespace coding::rans
       {
         std::printf( "[DEC] \t\t\t\t\t\t x: %lu -> ", x );
       }
-      x = ( ft.f( s ) * ( x >> _NumBase ) ) + ( x & mask ) - ft.cdf( s );
+      auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, x & mask );
+      x = ( f * ( x >> _NumBase ) ) + ( x & mask ) - cdf;
       if ( verbose )
       {
         std::printf( "%lu\n", x );
@@ -0,0 +1,5 @@
+#include "rans_adaptive.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
@@ -0,0 +1,172 @@
+#ifndef CODING_RANS_ADAPTIVE_H_INCLUDED
+#define CODING_RANS_ADAPTIVE_H_INCLUDED
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "num_freq_table_adapt.h"
+
+namespace coding::rans
+{
+
+  // adaptive rANS; frequencies come from num_freq_table_adapt updated after
+  //  every symbol, so no header is transmitted; decoder has to see symbols
+  //  in order, so encoder runs model front to back first and then codes
+  //  symbols back to front ( as for forward layout ); state lives in
+  //  [L, 2^32) with L = 2^16 and is renormalized 16 bits at a time
+  //
+  // stream layout (read front to back by the decoder):
+  //  [symbol count][final state][renormalization words]
+  // symbol count and state are uint
+
+  namespace detail
+  {
+    constexpr ulong adaptive_lower_bound = 1ul << 16ul;
+    constexpr ulong adaptive_word_mask = ( 1ul << 16ul ) - 1ul;
+  }  // namespace detail
+
+  template < std::size_t _NumBase, std::size_t _Rate, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen > encode_adaptive( data_block< _DataSize, _SymLen > &src,
+                                          bit_buffer< _BufSize > &dst )
+  {
+    static_assert( _NumBase <= 15u, "numeral base too large for 32-bit state" );
+
+    using table_type = num_freq_table_adapt< _SymLen, _NumBase, _Rate >;
+    using num_type = typename table_type::num_type;
+
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // model is run front to back, f(S) and C(S) of every symbol are kept
+    auto ft = table_type();
+    auto coded = std::vector< std::pair< num_type, num_type > >{};
+    coded.reserve( src.symbol_count() );
+    uint counts_p[ 1u << _SymLen ] = {};
+    while ( src )
+    {
+      auto s = src.read_symbol();
+      coded.emplace_back( ft.f( s ), ft.cdf( s ) );
+      ft.update( s );
+      ++counts_p[ s ];
+    }
+    src.rewind();
+
+    // ---------------
+
+    const ulong MASK = detail::adaptive_word_mask;
+    const ulong d = 32 - _NumBase;
+    const auto n = coded.size();
+
+    // words are collected in order of emission and written reversed
+    auto words = std::vector< word >{};
+    words.reserve( ( n * _SymLen >> 4u ) + 2u );
+
+    ulong x = detail::adaptive_lower_bound;
+    for ( std::size_t i = n; i > 0u; --i )
+    {
+      auto f = static_cast< ulong >( coded[ i - 1u ].first );
+      auto cdf = static_cast< ulong >( coded[ i - 1u ].second );
+      if ( x >= ( f << d ) )
+      {
+        words.push_back( static_cast< word >( x & MASK ) );
+        x >>= 16ul;
+      }
+      x = ( ( x / f ) << _NumBase ) + ( x % f ) + cdf;
+    }
+
+    dst.write_value( static_cast< uint >( n ) );
+    dst.write_value( static_cast< uint >( x ) );
+
+    auto *words_p = dst.claim( words.size() * sizeof( word ) );
+    for ( std::size_t i = words.size(); i > 0u; --i )
+    {
+      std::memcpy( words_p, &words[ i - 1u ], sizeof( word ) );
+      words_p += sizeof( word );
+    }
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats ( entropy of static model of whole block )
+    double bits = 0.0;
+    for ( auto count : counts_p )
+    {
+      if ( count != 0u )
+      {
+        auto pr = static_cast< double >( count ) / static_cast< double >( n );
+        bits -= pr * std::log2( pr );
+      }
+    }
+    stats.set_header_length( 0u );
+    stats.set_symbol_count( static_cast< ulong >( n ) );
+    stats.set_bits_per_symbol_theory( bits );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  // decodes adaptive stream starting at cursor of src, appending symbols to
+  //  dst
+  template < std::size_t _NumBase, std::size_t _Rate, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_adaptive( bit_buffer< _BufSize > &src,
+                   data_block< _DataSize, _SymLen > &dst )
+  {
+    using table_type = num_freq_table_adapt< _SymLen, _NumBase, _Rate >;
+    using num_type = typename table_type::num_type;
+
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // decode symbol count and initial state
+    uint count = 0u;
+    src.read( sizeof( uint ), &count );
+    uint state = 0u;
+    src.read( sizeof( uint ), &state );
+
+    // ---------------
+
+    auto ft = table_type();
+    auto mask = static_cast< ulong >( ft.num_mask() );
+    auto x = static_cast< ulong >( state );
+
+    for ( uint i = 0u; i < count; ++i )
+    {
+      auto slot = x & mask;
+      auto s = ft.symbol( static_cast< num_type >( slot ) );
+      dst.write_symbol( s );
+      x = ( static_cast< ulong >( ft.f( s ) ) * ( x >> _NumBase ) ) + slot -
+          static_cast< ulong >( ft.cdf( s ) );
+      if ( x < detail::adaptive_lower_bound )
+      {
+        x = ( x << 16ul ) + static_cast< ulong >( src.read_word() );
+      }
+      ft.update( s );
+    }
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_ADAPTIVE_H_INCLUDED
@@ -0,0 +1,5 @@
+#include "rans_batch.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
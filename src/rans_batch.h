@@ -0,0 +1,451 @@
+#ifndef CODING_RANS_BATCH_H_INCLUDED
+#define CODING_RANS_BATCH_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "header_codec.h"
+
+namespace coding::rans
+{
+
+  // batch of independent short messages ( e.g. records ); _Lanes messages
+  //  are coded together, each by its own state, so that their chains of
+  //  dependent divisions and multiplications overlap; every message gets
+  //  its own span of output, decodable on its own in forward order; state
+  //  lives in [L, 2^32) with L = 2^16 and is renormalized 16 bits at a time
+  //
+  // span layout (read front to back by the decoder):
+  //  [header][symbol count][final state][renormalization words]
+  // header is written only with per-message model, symbol count in 7-bit
+  //  groups and state is uint
+
+  // place of coded message in buffer
+  struct message_span
+  {
+    std::size_t offset;  // from beginning of buffer
+    std::size_t size;    // in bytes
+  };
+
+  namespace detail
+  {
+    constexpr ulong batch_lower_bound = 1ul << 16ul;
+    constexpr ulong batch_word_mask = ( 1ul << 16ul ) - 1ul;
+
+    template < std::size_t _Lanes >
+    constexpr bool is_supported_batch_lane_count() noexcept
+    {
+      return _Lanes == 1u || _Lanes == 2u || _Lanes == 4u || _Lanes == 8u;
+    }
+
+    // codes count <= _Lanes messages, words of message k are collected in
+    //  words_p[ k ] in order of emission
+    template < std::size_t _NumBase, std::size_t _Lanes, typename _Table,
+               std::size_t _DataSize, std::size_t _SymLen >
+    void encode_group( _Table const *const *tables_p,
+                       data_block< _DataSize, _SymLen > *src_p,
+                       std::size_t count, std::vector< word > *words_p,
+                       ulong *states_p )
+    {
+      const ulong MASK = batch_word_mask;
+      const ulong d = 32 - _NumBase;
+
+      ulong x[ _Lanes ];
+      std::size_t left[ _Lanes ];
+      std::size_t fill[ _Lanes ];
+      std::size_t lanes_p[ _Lanes ];
+      sym_word< _SymLen > span_p[ _Lanes ][ unpacked_span_size ];
+      for ( std::size_t k = 0u; k < count; ++k )
+      {
+        x[ k ] = batch_lower_bound;
+        src_p[ k ].fast_forward();
+        left[ k ] = src_p[ k ].symbol_count();
+        fill[ k ] = 0u;
+        words_p[ k ].clear();
+      }
+
+      for ( ;; )
+      {
+        // spans are refilled from end of their messages, lanes with symbols
+        //  left take equal steps
+        std::size_t active = 0u;
+        auto step = unpacked_span_size;
+        for ( std::size_t k = 0u; k < count; ++k )
+        {
+          if ( fill[ k ] == 0u && left[ k ] > 0u )
+          {
+            fill[ k ] = std::min( left[ k ], unpacked_span_size );
+            src_p[ k ].read_symbols_reverse( span_p[ k ], fill[ k ] );
+            left[ k ] -= fill[ k ];
+          }
+          if ( fill[ k ] > 0u )
+          {
+            lanes_p[ active++ ] = k;
+            step = std::min( step, fill[ k ] );
+          }
+        }
+        if ( active == 0u )
+        {
+          break;
+        }
+
+        for ( std::size_t j = 0u; j < step; ++j )
+        {
+          for ( std::size_t a = 0u; a < active; ++a )
+          {
+            auto k = lanes_p[ a ];
+            auto const &ft = *tables_p[ k ];
+            auto s = span_p[ k ][ --fill[ k ] ];
+            auto &xk = x[ k ];
+            if ( xk >= ( static_cast< ulong >( ft.f( s ) ) << d ) )
+            {
+              words_p[ k ].push_back( static_cast< word >( xk & MASK ) );
+              xk >>= 16ul;
+            }
+            xk = ( ( xk / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
+                 ft.rans_encode_adjust( s, xk );
+          }
+        }
+      }
+
+      for ( std::size_t k = 0u; k < count; ++k )
+      {
+        src_p[ k ].rewind();
+        states_p[ k ] = x[ k ];
+      }
+    }
+
+    // symbol count, final state and words of message after its header
+    template < std::size_t _BufSize >
+    void write_span( bit_buffer< _BufSize > &dst, std::size_t count,
+                     ulong state, std::vector< word > const &words )
+    {
+      do
+      {
+        auto group = static_cast< byte >( count & 0x7fu );
+        count >>= 7u;
+        dst.write_value(
+          static_cast< byte >( group | ( count != 0u ? 0x80u : 0u ) ) );
+      } while ( count != 0u );
+      dst.write_value( static_cast< uint >( state ) );
+
+      auto *words_p = dst.claim( words.size() * sizeof( word ) );
+      for ( std::size_t i = words.size(); i > 0u; --i )
+      {
+        std::memcpy( words_p, &words[ i - 1u ], sizeof( word ) );
+        words_p += sizeof( word );
+      }
+    }
+
+    // reads symbol count and final state, moves data_p to first word
+    inline std::size_t read_span( byte const *&data_p, ulong &state ) noexcept
+    {
+      std::size_t count = 0u;
+      for ( std::size_t shift = 0u;; shift += 7u )
+      {
+        auto group = *data_p++;
+        count |= static_cast< std::size_t >( group & 0x7fu ) << shift;
+        if ( ( group & 0x80u ) == 0u )
+        {
+          break;
+        }
+      }
+      uint value = 0u;
+      std::memcpy( &value, data_p, sizeof( uint ) );
+      data_p += sizeof( uint );
+      state = static_cast< ulong >( value );
+      return count;
+    }
+
+    // decodes count <= _Lanes spans whose words start at data_p[ k ],
+    //  appending symbols to dst_p[ k ]
+    template < std::size_t _NumBase, std::size_t _Lanes, typename _Table,
+               std::size_t _DataSize, std::size_t _SymLen >
+    void decode_group( _Table const *const *tables_p, byte const **data_p,
+                       std::size_t const *counts_p, ulong const *states_p,
+                       std::size_t count,
+                       data_block< _DataSize, _SymLen > *dst_p )
+    {
+      ulong x[ _Lanes ];
+      std::size_t left[ _Lanes ];
+      std::size_t fill[ _Lanes ];
+      std::size_t lanes_p[ _Lanes ];
+      sym_word< _SymLen > span_p[ _Lanes ][ unpacked_span_size ];
+      for ( std::size_t k = 0u; k < count; ++k )
+      {
+        x[ k ] = states_p[ k ];
+        left[ k ] = counts_p[ k ];
+        fill[ k ] = 0u;
+      }
+
+      for ( ;; )
+      {
+        // full spans are written out, lanes with symbols left take equal
+        //  steps
+        std::size_t active = 0u;
+        auto step = unpacked_span_size;
+        for ( std::size_t k = 0u; k < count; ++k )
+        {
+          if ( fill[ k ] == unpacked_span_size )
+          {
+            dst_p[ k ].write_symbols( span_p[ k ], fill[ k ] );
+            fill[ k ] = 0u;
+          }
+          if ( left[ k ] > 0u )
+          {
+            lanes_p[ active++ ] = k;
+            step = std::min(
+              step, std::min( left[ k ], unpacked_span_size - fill[ k ] ) );
+          }
+        }
+        if ( active == 0u )
+        {
+          break;
+        }
+
+        for ( std::size_t j = 0u; j < step; ++j )
+        {
+          for ( std::size_t a = 0u; a < active; ++a )
+          {
+            auto k = lanes_p[ a ];
+            auto const &ft = *tables_p[ k ];
+            using num_type = decltype( ft.num_mask() );
+            auto mask = static_cast< ulong >( ft.num_mask() );
+            auto &xk = x[ k ];
+            auto s = ft.symbol( static_cast< num_type >( xk & mask ) );
+            span_p[ k ][ fill[ k ]++ ] = s;
+            auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, xk & mask );
+            xk = ( f * ( xk >> _NumBase ) ) + ( xk & mask ) - cdf;
+            if ( xk < batch_lower_bound )
+            {
+              word w;
+              std::memcpy( &w, data_p[ k ], sizeof( word ) );
+              data_p[ k ] += sizeof( word );
+              xk = ( xk << 16ul ) + static_cast< ulong >( w );
+            }
+          }
+        }
+        for ( std::size_t a = 0u; a < active; ++a )
+        {
+          left[ lanes_p[ a ] ] -= step;
+        }
+      }
+
+      for ( std::size_t k = 0u; k < count; ++k )
+      {
+        dst_p[ k ].write_symbols( span_p[ k ], fill[ k ] );
+      }
+    }
+
+    // tables_p[ k ] == nullptr stands for table of message written in its
+    //  span
+    template < std::size_t _NumBase,
+               template < std::size_t, std::size_t > class _FreqTable,
+               std::size_t _Lanes, std::size_t _BufSize,
+               std::size_t _DataSize, std::size_t _SymLen >
+    compr_stats< _SymLen >
+    encode_batch( _FreqTable< _SymLen, _NumBase > const *model_p,
+                  data_block< _DataSize, _SymLen > *messages_p,
+                  std::size_t count, bit_buffer< _BufSize > &dst,
+                  message_span *spans_p )
+    {
+      static_assert( is_supported_batch_lane_count< _Lanes >(),
+                     "supported lane counts: 1, 2, 4, 8" );
+      static_assert( _NumBase <= 15u,
+                     "numeral base too large for 32-bit state" );
+      using table_type = _FreqTable< _SymLen, _NumBase >;
+
+      auto stats = compr_stats< _SymLen >{};
+
+      // start encoding
+      auto start_time = std::chrono::high_resolution_clock::now();
+
+      // tables of messages and scratch are reused by groups
+      auto tables = std::vector< table_type >( model_p == nullptr ? _Lanes
+                                                                  : 0u );
+      auto writer = coding::detail::header_writer{};
+      auto words = std::vector< std::vector< word > >( _Lanes );
+      table_type const *tables_p[ _Lanes ];
+      ulong states_p[ _Lanes ];
+
+      std::size_t symbols = 0u;
+      std::size_t header_bytes = 0u;
+      auto length = dst.length();
+      for ( std::size_t i = 0u; i < count; i += _Lanes )
+      {
+        auto n = std::min( _Lanes, count - i );
+        for ( std::size_t k = 0u; k < n; ++k )
+        {
+          if ( model_p == nullptr )
+          {
+            messages_p[ i + k ].rewind();
+            tables[ k ].assign( messages_p[ i + k ] );
+            tables_p[ k ] = &tables[ k ];
+          }
+          else
+          {
+            tables_p[ k ] = model_p;
+          }
+        }
+
+        encode_group< _NumBase, _Lanes >( tables_p, messages_p + i, n,
+                                          words.data(), states_p );
+
+        for ( std::size_t k = 0u; k < n; ++k )
+        {
+          auto offset = static_cast< std::size_t >( dst.curr() - dst.data() );
+          if ( model_p == nullptr )
+          {
+            auto header_length = dst.length();
+            tables[ k ].write_header( dst, writer );
+            header_bytes += ( dst.length() - header_length ) >> 3u;
+          }
+          auto message_count = messages_p[ i + k ].symbol_count();
+          write_span( dst, message_count, states_p[ k ], words[ k ] );
+          auto end = static_cast< std::size_t >( dst.curr() - dst.data() );
+          spans_p[ i + k ] = message_span{ offset, end - offset };
+          symbols += message_count;
+        }
+      }
+
+      // end encoding
+      auto encoding_time =
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+          std::chrono::high_resolution_clock::now() - start_time );
+
+      // write current run stats, of all messages
+      stats.set_header_length( static_cast< ulong >( header_bytes ) << 3u );
+      stats.set_symbol_count( static_cast< ulong >( symbols ) );
+      stats.set_encoded_length( dst.length() - length );
+      stats.set_encoding_time( encoding_time );
+
+      return stats;
+    }
+
+    template < std::size_t _NumBase,
+               template < std::size_t, std::size_t > class _FreqTable,
+               std::size_t _Lanes, std::size_t _BufSize,
+               std::size_t _DataSize, std::size_t _SymLen >
+    std::chrono::nanoseconds
+    decode_batch( _FreqTable< _SymLen, _NumBase > const *model_p,
+                  bit_buffer< _BufSize > const &src,
+                  message_span const *spans_p, std::size_t count,
+                  data_block< _DataSize, _SymLen > *messages_p )
+    {
+      static_assert( is_supported_batch_lane_count< _Lanes >(),
+                     "supported lane counts: 1, 2, 4, 8" );
+      static_assert( _NumBase <= 15u,
+                     "numeral base too large for 32-bit state" );
+      using table_type = _FreqTable< _SymLen, _NumBase >;
+
+      // start decoding
+      auto start_time = std::chrono::high_resolution_clock::now();
+
+      auto tables = std::vector< table_type >( model_p == nullptr ? _Lanes
+                                                                  : 0u );
+      table_type const *tables_p[ _Lanes ];
+      byte const *data_p[ _Lanes ];
+      std::size_t counts_p[ _Lanes ];
+      ulong states_p[ _Lanes ];
+
+      for ( std::size_t i = 0u; i < count; i += _Lanes )
+      {
+        auto n = std::min( _Lanes, count - i );
+        for ( std::size_t k = 0u; k < n; ++k )
+        {
+          auto const &span = spans_p[ i + k ];
+          data_p[ k ] = src.data() + span.offset;
+          if ( model_p == nullptr )
+          {
+            auto header = bit_buffer< read_only_view >( data_p[ k ],
+                                                        span.size );
+            tables[ k ].assign_header( header );
+            data_p[ k ] = header.curr();
+            tables_p[ k ] = &tables[ k ];
+          }
+          else
+          {
+            tables_p[ k ] = model_p;
+          }
+          counts_p[ k ] = read_span( data_p[ k ], states_p[ k ] );
+        }
+
+        decode_group< _NumBase, _Lanes >( tables_p, data_p, counts_p,
+                                          states_p, n, messages_p + i );
+      }
+
+      // end decoding
+      return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::high_resolution_clock::now() - start_time );
+    }
+  }  // namespace detail
+
+  // codes count messages with shared model known to decoder ( static or
+  //  trained one ); span of message i is written to spans_p[ i ]
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes = 4u, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode_batch( _FreqTable< _SymLen, _NumBase > const &model,
+                data_block< _DataSize, _SymLen > *messages_p,
+                std::size_t count, bit_buffer< _BufSize > &dst,
+                message_span *spans_p )
+  {
+    return detail::encode_batch< _NumBase, _FreqTable, _Lanes >(
+      &model, messages_p, count, dst, spans_p );
+  }
+
+  // same with model of every message counted and written in its span
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes = 4u, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode_batch( data_block< _DataSize, _SymLen > *messages_p,
+                std::size_t count, bit_buffer< _BufSize > &dst,
+                message_span *spans_p )
+  {
+    return detail::encode_batch< _NumBase, _FreqTable, _Lanes >(
+      static_cast< _FreqTable< _SymLen, _NumBase > const * >( nullptr ),
+      messages_p, count, dst, spans_p );
+  }
+
+  // decodes count spans of src, appending symbols of span i to
+  //  messages_p[ i ]
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes = 4u, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_batch( _FreqTable< _SymLen, _NumBase > const &model,
+                bit_buffer< _BufSize > const &src,
+                message_span const *spans_p, std::size_t count,
+                data_block< _DataSize, _SymLen > *messages_p )
+  {
+    return detail::decode_batch< _NumBase, _FreqTable, _Lanes >(
+      &model, src, spans_p, count, messages_p );
+  }
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes = 4u, std::size_t _BufSize,
+             std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_batch( bit_buffer< _BufSize > const &src,
+                message_span const *spans_p, std::size_t count,
+                data_block< _DataSize, _SymLen > *messages_p )
+  {
+    return detail::decode_batch< _NumBase, _FreqTable, _Lanes >(
+      static_cast< _FreqTable< _SymLen, _NumBase > const * >( nullptr ), src,
+      spans_p, count, messages_p );
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_BATCH_H_INCLUDED
@@ -0,0 +1,5 @@
+#include "rans_context.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
@@ -0,0 +1,87 @@
+#ifndef CODING_RANS_CONTEXT_H_INCLUDED
+#define CODING_RANS_CONTEXT_H_INCLUDED
+
+#include <chrono>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "freq_normalize.h"
+#include "header_codec.h"
+#include "rans.h"
+
+namespace coding::rans
+{
+
+  // long-lived coder of stream of blocks, same stream as rans::encode and
+  //  rans::decode; frequency table, normalization and header scratch are kept
+  //  between calls and reset in place, so that besides growth of output nothing is
+  //  allocated per block ( tables of large alphabets are large, context is
+  //  better kept on heap )
+  template < std::size_t SL, std::size_t N,
+             template < std::size_t, std::size_t > class _FreqTable,
+             typename _Policy = rans32 >
+  class codec_context
+  {
+  public:
+    using table_type = _FreqTable< SL, N >;
+
+    template < std::size_t _BufSize, std::size_t _DataSize >
+    compr_stats< SL > encode( data_block< _DataSize, SL > &src,
+                              bit_buffer< _BufSize > &dst )
+    {
+      auto stats = compr_stats< SL >{};
+
+      // start encoding
+      auto start_time = std::chrono::high_resolution_clock::now();
+
+      m_table.assign( src, m_normalize_scratch );
+      src.rewind();
+
+      detail::encode_symbols< N, _Policy >( m_table, src, dst );
+
+      auto length = dst.length();
+      m_table.write_header( dst, m_header_writer );
+
+      // end encoding
+      auto encoding_time =
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+          std::chrono::high_resolution_clock::now() - start_time );
+
+      // write current run stats
+      stats.set_header_length( dst.length() - length );
+      stats.set_symbol_count( m_table.symbol_count() );
+      stats.set_bits_per_symbol_theory( m_table.bits_per_symbol_theory() );
+      stats.set_encoded_length( dst.length() );
+      stats.set_encoding_time( encoding_time );
+
+      return stats;
+    }
+
+    template < std::size_t _BufSize, std::size_t _DataSize >
+    std::chrono::nanoseconds decode( bit_buffer< _BufSize > &src,
+                                     data_block< _DataSize, SL > &dst )
+    {
+      // start decoding
+      auto start_time = std::chrono::high_resolution_clock::now();
+
+      m_table.assign_header_reverse( src );
+      detail::decode_symbols< N, _Policy >( m_table, src, dst );
+
+      // end decoding
+      return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::high_resolution_clock::now() - start_time );
+    }
+
+    // table of last coded block
+    table_type const &table() const noexcept { return m_table; }
+
+  private:
+    table_type m_table{};
+    normalize_scratch m_normalize_scratch{ std::size_t{ 1u } << SL };
+    coding::detail::header_writer m_header_writer;
+  };
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_CONTEXT_H_INCLUDED
@@ -0,0 +1,5 @@
+#include "rans_interleaved.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
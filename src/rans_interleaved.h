@@ -0,0 +1,185 @@
+#ifndef CODING_RANS_INTERLEAVED_H_INCLUDED
+#define CODING_RANS_INTERLEAVED_H_INCLUDED
+
+#include <chrono>
+#include <cstdio>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+
+namespace coding::rans
+{
+
+  // interleaved rANS with _Lanes independent states sharing one bit buffer;
+  //  symbol i is coded by state i % _Lanes, every state lives in [L, 2^32)
+  //  with L = 2^16 and is renormalized 16 bits at a time
+  //
+  // stream layout (read back to front by the decoder):
+  //  [renormalization words][_Lanes final states][symbol count][header]
+
+  namespace detail
+  {
+    constexpr ulong interleaved_lower_bound = 1ul << 16ul;
+    constexpr ulong interleaved_word_mask = ( 1ul << 16ul ) - 1ul;
+
+    template < std::size_t _Lanes >
+    constexpr bool is_supported_lane_count() noexcept
+    {
+      return _Lanes == 2u || _Lanes == 4u || _Lanes == 8u;
+    }
+  }  // namespace detail
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode_interleaved( data_block< _DataSize, _SymLen > &src,
+                      bit_buffer< _BufSize > &dst )
+  {
+    static_assert( detail::is_supported_lane_count< _Lanes >(),
+                   "supported lane counts: 2, 4, 8" );
+    static_assert( _NumBase <= 15u, "numeral base too large for 32-bit state" );
+
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // compute frequency table from data block
+    auto ft = _FreqTable< _SymLen, _NumBase >( src );
+    src.rewind();
+
+    // ---------------
+
+    const ulong MASK = detail::interleaved_word_mask;
+    const ulong d = 32 - _NumBase;
+    const auto n = src.symbol_count();
+
+    ulong x[ _Lanes ];
+    for ( std::size_t lane = 0u; lane < _Lanes; ++lane )
+    {
+      x[ lane ] = detail::interleaved_lower_bound;
+    }
+
+    for ( std::size_t i = 0u; i < n; ++i )
+    {
+      auto &xl = x[ i & ( _Lanes - 1u ) ];
+      auto s = static_cast< ulong >( src.read_symbol() );
+      if ( xl >= ( static_cast< ulong >( ft.f( s ) ) << d ) )
+      {
+        dst.write_word( static_cast< word >( xl & MASK ) );
+        xl >>= 16ul;
+      }
+      xl = ( ( xl / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
+           ft.rans_encode_adjust( static_cast< sym_word< _SymLen > >( s ), xl );
+    }
+
+    // final states are flushed whole, followed by the symbol count
+    for ( std::size_t lane = 0u; lane < _Lanes; ++lane )
+    {
+      auto state = static_cast< uint >( x[ lane ] );
+      dst.write( sizeof( uint ), &state );
+    }
+    auto count = static_cast< uint >( n );
+    dst.write( sizeof( uint ), &count );
+
+    ft.write_header( dst );
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats
+    stats.set_header_length( ft.header_length() );
+    stats.set_symbol_count( ft.symbol_count() );
+    stats.set_bits_per_symbol_theory( ft.bits_per_symbol_theory() );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_interleaved( bit_buffer< _BufSize > &src,
+                      data_block< _DataSize, _SymLen > &dst )
+  {
+    static_assert( detail::is_supported_lane_count< _Lanes >(),
+                   "supported lane counts: 2, 4, 8" );
+    static_assert( _NumBase <= 15u, "numeral base too large for 32-bit state" );
+
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // decode frequency table, symbol count and final states from input bits
+    auto ft = _FreqTable< _SymLen, _NumBase >::read_header_reverse( src );
+
+    uint count = 0u;
+    src.read_reverse( sizeof( uint ), &count );
+    auto n = static_cast< std::size_t >( count );
+
+    ulong x[ _Lanes ];
+    for ( std::size_t lane = _Lanes; lane > 0u; --lane )
+    {
+      uint state = 0u;
+      src.read_reverse( sizeof( uint ), &state );
+      x[ lane - 1u ] = static_cast< ulong >( state );
+    }
+
+    if ( !dst.prepare( n ) )
+    {
+      std::printf( "Decoded block too small for %lu symbols.\n", n );
+      return std::chrono::nanoseconds{};
+    }
+
+    // ---------------
+
+    auto mask = static_cast< ulong >( ft.num_mask() );
+
+    auto decode_step = [ & ]( ulong &xl ) {
+      auto s = ft.symbol( static_cast< word >( xl & mask ) );
+      dst.write_symbol_reverse( s );
+      auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, xl & mask );
+      xl = ( f * ( xl >> _NumBase ) ) + ( xl & mask ) - cdf;
+      if ( xl < detail::interleaved_lower_bound )
+      {
+        xl = ( xl << 16ul ) + static_cast< ulong >( src.read_word_reverse() );
+      }
+    };
+
+    // trailing partial round first, then whole rounds of independent states
+    auto i = n;
+    while ( ( i & ( _Lanes - 1u ) ) != 0u )
+    {
+      --i;
+      decode_step( x[ i & ( _Lanes - 1u ) ] );
+    }
+
+    while ( i > 0u )
+    {
+      for ( std::size_t lane = _Lanes; lane > 0u; --lane )
+      {
+        decode_step( x[ lane - 1u ] );
+      }
+      i -= _Lanes;
+    }
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_INTERLEAVED_H_INCLUDED
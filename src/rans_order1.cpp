@@ -0,0 +1,5 @@
+#include "rans_order1.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
@@ -0,0 +1,161 @@
+#ifndef CODING_RANS_ORDER1_H_INCLUDED
+#define CODING_RANS_ORDER1_H_INCLUDED
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "num_freq_table_o1.h"
+
+namespace coding::rans
+{
+
+  // order-1 rANS; every symbol is coded with distribution of its context
+  //  ( preceding symbol ), which decoder knows only when decoding front to
+  //  back, so that forward layout is used; state lives in [L, 2^32) with
+  //  L = 2^16 and is renormalized 16 bits at a time
+  //
+  // stream layout (read front to back by the decoder):
+  //  [header length][header][symbol count][final state][renormalization words]
+  // header length, symbol count and state are uint
+
+  namespace detail
+  {
+    constexpr ulong order1_lower_bound = 1ul << 16ul;
+    constexpr ulong order1_word_mask = ( 1ul << 16ul ) - 1ul;
+  }  // namespace detail
+
+  template < std::size_t _NumBase, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  compr_stats< _SymLen > encode_order1( data_block< _DataSize, _SymLen > &src,
+                                        bit_buffer< _BufSize > &dst )
+  {
+    static_assert( _NumBase <= 15u, "numeral base too large for 32-bit state" );
+
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // compute frequency tables from data block
+    auto ft = num_freq_table_o1< _SymLen, _NumBase >( src );
+
+    // ---------------
+
+    const ulong MASK = detail::order1_word_mask;
+    const ulong d = 32 - _NumBase;
+    const auto n = src.symbol_count();
+
+    // words are collected in order of emission and written reversed
+    auto words = std::vector< word >{};
+    words.reserve( ( n * _SymLen >> 4u ) + 2u );
+
+    // symbols are walked back to front, context is read ahead
+    ulong x = detail::order1_lower_bound;
+    src.fast_forward();
+    auto s = n > 0u ? static_cast< std::size_t >( src.read_symbol_reverse() )
+                    : 0u;
+    for ( std::size_t i = n; i > 0u; --i )
+    {
+      auto ctx = i > 1u
+                   ? static_cast< std::size_t >( src.read_symbol_reverse() )
+                   : 0u;
+      auto f = static_cast< ulong >( ft.f( ctx, s ) );
+      if ( x >= ( f << d ) )
+      {
+        words.push_back( static_cast< word >( x & MASK ) );
+        x >>= 16ul;
+      }
+      x = ( ( x / f ) << _NumBase ) + ( x % f ) +
+          static_cast< ulong >( ft.cdf( ctx, s ) );
+      s = ctx;
+    }
+    src.rewind();
+
+    auto header = bit_buffer< dynamic_size >();
+    ft.write_header( header );
+    dst.write_value( static_cast< uint >( header.size() ) );
+    dst.write( header.size(), header.data() );
+    dst.write_value( static_cast< uint >( n ) );
+    dst.write_value( static_cast< uint >( x ) );
+
+    auto *words_p = dst.claim( words.size() * sizeof( word ) );
+    for ( std::size_t i = words.size(); i > 0u; --i )
+    {
+      std::memcpy( words_p, &words[ i - 1u ], sizeof( word ) );
+      words_p += sizeof( word );
+    }
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats
+    stats.set_header_length( static_cast< ulong >( header.size() ) << 3u );
+    stats.set_symbol_count( ft.symbol_count() );
+    stats.set_bits_per_symbol_theory( ft.bits_per_symbol_theory() );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  // decodes order-1 stream starting at cursor of src, appending symbols to
+  //  dst
+  template < std::size_t _NumBase, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_order1( bit_buffer< _BufSize > &src,
+                 data_block< _DataSize, _SymLen > &dst )
+  {
+    using table_type = num_freq_table_o1< _SymLen, _NumBase >;
+    using num_type = typename table_type::num_type;
+
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // decode frequency tables, symbol count and initial state
+    src.advance( sizeof( uint ) );
+    auto ft = table_type( src );
+    uint count = 0u;
+    src.read( sizeof( uint ), &count );
+    uint state = 0u;
+    src.read( sizeof( uint ), &state );
+
+    // ---------------
+
+    auto mask = static_cast< ulong >( ft.num_mask() );
+    auto x = static_cast< ulong >( state );
+
+    std::size_t ctx = 0u;
+    for ( uint i = 0u; i < count; ++i )
+    {
+      auto slot = x & mask;
+      auto s = ft.symbol( ctx, static_cast< num_type >( slot ) );
+      dst.write_symbol( s );
+      x = ( static_cast< ulong >( ft.f( ctx, s ) ) * ( x >> _NumBase ) ) +
+          slot - static_cast< ulong >( ft.cdf( ctx, s ) );
+      if ( x < detail::order1_lower_bound )
+      {
+        x = ( x << 16ul ) + static_cast< ulong >( src.read_word() );
+      }
+      ctx = s;
+    }
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_ORDER1_H_INCLUDED
@@ -0,0 +1,5 @@
+#include "rans_parallel.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
@@ -0,0 +1,373 @@
+#ifndef CODING_RANS_PARALLEL_H_INCLUDED
+#define CODING_RANS_PARALLEL_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "rans_interleaved.h"
+#include "rans_simd.h"
+#include "thread_pool.h"
+
+namespace coding::rans
+{
+
+  // block container; input is split into blocks of whole symbols coded
+  //  independently ( own frequency table and header, interleaved format with
+  //  simd_lanes states ), so that blocks can be encoded and decoded in
+  //  parallel and symbol ranges can be decoded without touching other blocks
+  //
+  // container layout (read back to front by the decoder):
+  //  [block 0]..[block k-1][k index entries][block streams length]
+  //  [symbol count][block count k]
+  // all fields are ulong except for uint block count; offsets are relative
+  // to container start
+
+  constexpr std::size_t default_parallel_block_size = 1u << 20u;
+
+  // index entry of single block
+  struct container_block
+  {
+    ulong symbol_offset;  // index of first symbol of block
+    ulong stream_offset;  // start of block stream
+    ulong header_offset;  // start of frequency table header in block stream
+  };
+
+  static_assert( sizeof( container_block ) == 3u * sizeof( ulong ),
+                 "index entries are stored as they are" );
+
+  // container index read from encoded bytes in [beg_p, end_p) ending at
+  //  end_p; throws std::invalid_argument if index does not fit in these bytes
+  //  or its offsets are not monotone and within container
+  class container_index
+  {
+  public:
+    container_index( byte const *beg_p, byte const *end_p )
+    {
+      constexpr auto trailer_size = 2u * sizeof( ulong ) + sizeof( uint );
+      auto available = static_cast< std::size_t >( end_p - beg_p );
+      if ( available < trailer_size )
+        throw std::invalid_argument( "block container truncated" );
+      available -= trailer_size;
+
+      uint count = 0u;
+      end_p -= sizeof( uint );
+      std::memcpy( &count, end_p, sizeof( uint ) );
+      end_p -= sizeof( ulong );
+      std::memcpy( &m_symbol_count, end_p, sizeof( ulong ) );
+      end_p -= sizeof( ulong );
+      std::memcpy( &m_streams_length, end_p, sizeof( ulong ) );
+
+      if ( count > available / sizeof( container_block ) )
+        throw std::invalid_argument( "block container truncated" );
+      available -= count * sizeof( container_block );
+      if ( m_streams_length > available )
+        throw std::invalid_argument( "block container truncated" );
+
+      m_blocks.resize( count );
+      end_p -= count * sizeof( container_block );
+      std::memcpy( static_cast< void * >( m_blocks.data() ), end_p,
+                   count * sizeof( container_block ) );
+
+      m_beg_p = end_p - m_streams_length;
+      check_offsets();
+    }
+
+    std::size_t size() const noexcept { return m_blocks.size(); }
+
+    ulong symbol_count() const noexcept { return m_symbol_count; }
+
+    container_block const &operator[]( std::size_t index ) const noexcept
+    {
+      return m_blocks[ index ];
+    }
+
+    // first byte of container
+    byte const *data() const noexcept { return m_beg_p; }
+
+    // container length including index
+    std::size_t length() const noexcept
+    {
+      return static_cast< std::size_t >( m_streams_length ) +
+             m_blocks.size() * sizeof( container_block ) +
+             2u * sizeof( ulong ) + sizeof( uint );
+    }
+
+    ulong stream_end( std::size_t index ) const noexcept
+    {
+      return index + 1u < m_blocks.size()
+               ? m_blocks[ index + 1u ].stream_offset
+               : m_streams_length;
+    }
+
+    ulong block_symbol_count( std::size_t index ) const noexcept
+    {
+      return ( index + 1u < m_blocks.size()
+                 ? m_blocks[ index + 1u ].symbol_offset
+                 : m_symbol_count ) -
+             m_blocks[ index ].symbol_offset;
+    }
+
+    // encoded block positioned for decoding
+    bit_buffer< read_only_view >
+    block_stream( std::size_t index ) const noexcept
+    {
+      auto beg = m_blocks[ index ].stream_offset;
+      auto size = static_cast< std::size_t >( stream_end( index ) - beg );
+      auto result = bit_buffer< read_only_view >( m_beg_p + beg, size );
+      result.fast_forward();
+      return result;
+    }
+
+    // index of block containing given symbol
+    std::size_t find( ulong symbol ) const noexcept
+    {
+      auto it = std::upper_bound(
+        m_blocks.begin(), m_blocks.end(), symbol,
+        []( ulong value, container_block const &block ) {
+          return value < block.symbol_offset;
+        } );
+      return static_cast< std::size_t >( it - m_blocks.begin() ) - 1u;
+    }
+
+  private:
+    // blocks must start at symbol and stream 0, follow each other and have
+    //  their headers within their own streams
+    void check_offsets() const
+    {
+      if ( m_blocks.empty() )
+      {
+        if ( m_symbol_count > 0u || m_streams_length > 0u )
+          throw std::invalid_argument( "block container without blocks" );
+        return;
+      }
+
+      if ( m_blocks.front().symbol_offset != 0u ||
+           m_blocks.front().stream_offset != 0u )
+        throw std::invalid_argument( "block container offsets out of range" );
+
+      for ( std::size_t i = 0u; i < m_blocks.size(); ++i )
+      {
+        auto const &block = m_blocks[ i ];
+        auto symbol_end = i + 1u < m_blocks.size()
+                            ? m_blocks[ i + 1u ].symbol_offset
+                            : m_symbol_count;
+        auto stream_end = this->stream_end( i );
+        if ( symbol_end < block.symbol_offset ||
+             stream_end < block.stream_offset ||
+             stream_end > m_streams_length ||
+             block.header_offset < block.stream_offset ||
+             block.header_offset > stream_end )
+          throw std::invalid_argument(
+            "block container offsets out of range" );
+      }
+    }
+
+    std::vector< container_block > m_blocks;
+    ulong m_streams_length = 0u;
+    ulong m_symbol_count = 0u;
+    byte const *m_beg_p = nullptr;
+  };
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen >
+  encode_parallel( data_block< _DataSize, _SymLen > &src,
+                   bit_buffer< _BufSize > &dst, thread_pool &pool,
+                   std::size_t block_size = default_parallel_block_size )
+  {
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // blocks are rounded to whole number of symbols filling whole bytes, so
+    //  that every block starts at byte boundary
+    constexpr std::size_t symbol_bytes = std::lcm( std::size_t{ 8u }, _SymLen )
+                                         >> 3u;
+    block_size = ( block_size + symbol_bytes - 1u ) / symbol_bytes *
+                 symbol_bytes;
+
+    auto total = src.size();
+    auto block_count = ( total + block_size - 1u ) / block_size;
+
+    // ---------------
+
+    // every block is encoded into its own buffer
+    auto blocks = std::vector< bit_buffer< dynamic_size > >( block_count );
+    auto block_stats = std::vector< compr_stats< _SymLen > >( block_count );
+    pool.run( block_count, [ & ]( std::size_t i ) {
+      auto beg = i * block_size;
+      auto view = data_block< read_only_view, _SymLen >(
+        src.data() + beg, std::min( block_size, total - beg ) );
+      blocks[ i ].reserve( view.size() + ( view.size() >> 2u ) + 1024u );
+      block_stats[ i ] =
+        encode_interleaved< _NumBase, _FreqTable, simd_lanes >( view,
+                                                                blocks[ i ] );
+    } );
+
+    // blocks are copied to their places in container in parallel
+    auto index = std::vector< container_block >( block_count );
+    ulong end = 0u;
+    for ( std::size_t i = 0u; i < block_count; ++i )
+    {
+      index[ i ].symbol_offset = ( i * block_size << 3u ) / _SymLen;
+      index[ i ].stream_offset = end;
+      end += blocks[ i ].size();
+      index[ i ].header_offset =
+        end - ( block_stats[ i ].header_length() >> 3u );
+    }
+
+    auto *container_p = dst.claim( static_cast< std::size_t >( end ) );
+    pool.run( block_count, [ & ]( std::size_t i ) {
+      std::memcpy( static_cast< void * >( container_p +
+                                          index[ i ].stream_offset ),
+                   static_cast< void const * >( blocks[ i ].data() ),
+                   blocks[ i ].size() );
+    } );
+
+    dst.write( block_count * sizeof( container_block ), index.data() );
+    dst.write_value( end );
+    dst.write_value( static_cast< ulong >( ( total << 3u ) / _SymLen ) );
+    dst.write_value( static_cast< uint >( block_count ) );
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats ( entropy averaged over blocks )
+    ulong header_length = 0u;
+    ulong symbol_count = 0u;
+    double bits = 0.0;
+    for ( auto const &bs : block_stats )
+    {
+      header_length += bs.header_length();
+      symbol_count += bs.symbol_count();
+      bits += bs.bits_per_symbol_theory() *
+              static_cast< double >( bs.symbol_count() );
+    }
+    stats.set_header_length( header_length );
+    stats.set_symbol_count( symbol_count );
+    stats.set_bits_per_symbol_theory(
+      symbol_count > 0u ? bits / static_cast< double >( symbol_count ) : 0.0 );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_parallel( bit_buffer< _BufSize > &src,
+                   data_block< _DataSize, _SymLen > &dst, thread_pool &pool )
+  {
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // decode container index
+    auto index = container_index( src.data(), src.curr() );
+    src.reverse( index.length() );
+
+    if ( !dst.prepare( static_cast< std::size_t >( index.symbol_count() ) ) )
+    {
+      std::printf( "Decoded block too small for %lu symbols.\n",
+                   index.symbol_count() );
+      return std::chrono::nanoseconds{};
+    }
+
+    // ---------------
+
+    // every block is decoded straight into its place in output
+    pool.run( index.size(), [ & ]( std::size_t i ) {
+      auto bits = index.block_stream( i );
+      auto out = data_block< dynamic_size, _SymLen >(
+        dst.data() + ( ( index[ i ].symbol_offset * _SymLen ) >> 3u ),
+        static_cast< std::size_t >(
+          index.block_symbol_count( i ) * _SymLen + 7u ) >>
+          3u );
+      decode_simd< _NumBase, _FreqTable, simd_lanes >( bits, out );
+    } );
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+  // decodes count symbols starting at given one into dst ( replacing its
+  //  contents ), touching only blocks covering that range; src is not
+  //  consumed, so that it can be queried repeatedly
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_range( bit_buffer< _BufSize > const &src,
+                data_block< _DataSize, _SymLen > &dst, ulong first,
+                ulong count )
+  {
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    auto index = container_index( src.data(), src.curr() );
+    first = std::min( first, index.symbol_count() );
+    count = std::min( count, index.symbol_count() - first );
+
+    dst.reset();
+    if ( !dst.reserve( static_cast< std::size_t >( count * _SymLen + 7u ) >>
+                       3u ) )
+    {
+      std::printf( "Decoded block too small for %lu symbols.\n", count );
+      return std::chrono::nanoseconds{};
+    }
+
+    // ---------------
+
+    auto block = data_block< dynamic_size, _SymLen >();
+    auto end = first + count;
+    for ( auto i = count > 0u ? index.find( first ) : index.size();
+          i < index.size() && index[ i ].symbol_offset < end; ++i )
+    {
+      auto bits = index.block_stream( i );
+      decode_simd< _NumBase, _FreqTable, simd_lanes >( bits, block );
+
+      // copy symbols of block within requested range
+      auto beg = std::max( first, index[ i ].symbol_offset ) -
+                 index[ i ].symbol_offset;
+      auto n = std::min( end - index[ i ].symbol_offset,
+                         index.block_symbol_count( i ) ) -
+               beg;
+      auto bit_pos = static_cast< std::size_t >( beg * _SymLen );
+      block.set_position( std::make_pair( bit_pos >> 3u, bit_pos & 7u ) );
+      for ( ulong j = 0u; j < n; ++j )
+      {
+        dst.write_symbol( block.read_symbol() );
+      }
+    }
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_PARALLEL_H_INCLUDED
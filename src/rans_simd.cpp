@@ -0,0 +1,5 @@
+#include "rans_simd.h"
+
+namespace coding::rans
+{
+}  // namespace coding::rans
@@ -0,0 +1,411 @@
+#ifndef CODING_RANS_SIMD_H_INCLUDED
+#define CODING_RANS_SIMD_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "bit_buffer.h"
+#include "data_block.h"
+#include "rans_interleaved.h"
+
+namespace coding::rans
+{
+
+  // vectorized decoder for streams written by encode_interleaved with 8 or
+  //  4 lanes; kernels are built for their instruction sets only and chosen
+  //  at run time: AVX2 keeps 8 states in one vector register, SSE4.1 keeps 4
+  //  ( 8 lanes as two halves ), processors without either use scalar code
+  //  with identical output
+
+  // lanes of streams written for SIMD decoding ( e.g. by encode_parallel ),
+  //  same on every processor
+  constexpr std::size_t simd_lanes = 8u;
+
+  enum class simd_kernel : byte
+  {
+    scalar = 0u,
+    sse41 = 1u,
+    avx2 = 2u,
+  };
+
+  // kernel decode_simd runs on this processor for given lane count
+  inline simd_kernel simd_kernel_for( std::size_t lanes ) noexcept
+  {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    static const bool has_avx2 = __builtin_cpu_supports( "avx2" ) != 0;
+    static const bool has_sse41 = __builtin_cpu_supports( "sse4.1" ) != 0;
+    if ( lanes == 8u && has_avx2 )
+    {
+      return simd_kernel::avx2;
+    }
+    if ( has_sse41 )
+    {
+      return simd_kernel::sse41;
+    }
+#endif
+    static_cast< void >( lanes );
+    return simd_kernel::scalar;
+  }
+
+  inline char const *simd_kernel_name( simd_kernel kernel ) noexcept
+  {
+    switch ( kernel )
+    {
+    case simd_kernel::avx2:
+      return "AVX2";
+    case simd_kernel::sse41:
+      return "SSE4.1";
+    default:
+      return "scalar";
+    }
+  }
+
+  // per-slot decoder data in 32-bit form suitable for vector gathers; f(s) in
+  //  low half and sign-extended bias in high half, so that decoding step is
+  //  x' = f * ( x >> N ) + ( x & mask ) - bias
+  template < std::size_t SL, std::size_t N >
+  class simd_dec_table
+  {
+  public:
+    static_assert( N <= 15u, "slot entries store 16-bit frequencies" );
+
+    template < typename _FreqTable >
+    explicit simd_dec_table( _FreqTable &ft ) noexcept
+    {
+      for ( std::size_t slot = 0u; slot < size(); ++slot )
+      {
+        auto s = ft.symbol( static_cast< word >( slot ) );
+        auto [ f, bias ] = ft.adjusted_f_and_cdf( s, slot );
+        m_symbols_p[ slot ] = s;
+        m_entries_p[ slot ] =
+          static_cast< uint >( f & 0xfffful ) |
+          ( static_cast< uint >( bias & 0xfffful ) << 16u );
+      }
+    }
+
+    static std::size_t size() noexcept { return 1u << N; }
+
+    uint const *entries() const noexcept { return m_entries_p; }
+
+    sym_word< SL > symbol( std::size_t slot ) const noexcept
+    {
+      return m_symbols_p[ slot ];
+    }
+
+    uint decode( uint x ) const noexcept
+    {
+      auto slot = x & ( ( 1u << N ) - 1u );
+      auto e = m_entries_p[ slot ];
+      auto bias = static_cast< std::int16_t >( e >> 16u );
+      return ( e & 0xffffu ) * ( x >> N ) + slot -
+             static_cast< uint >( static_cast< std::int32_t >( bias ) );
+    }
+
+  private:
+    uint m_entries_p[ 1u << N ] = {};
+    sym_word< SL > m_symbols_p[ 1u << N ] = {};
+  };
+
+  namespace detail
+  {
+    template < std::size_t SL, std::size_t N, std::size_t _BufSize,
+               std::size_t _DataSize >
+    void simd_decode_step( uint &x, simd_dec_table< SL, N > const &dt,
+                           bit_buffer< _BufSize > &src,
+                           data_block< _DataSize, SL > &dst )
+    {
+      dst.write_symbol_reverse( dt.symbol( x & ( ( 1u << N ) - 1u ) ) );
+      x = dt.decode( x );
+      if ( x < interleaved_lower_bound )
+      {
+        x = ( x << 16u ) + static_cast< uint >( src.read_word_reverse() );
+      }
+    }
+
+    template < std::size_t _Lanes, std::size_t SL, std::size_t N,
+               std::size_t _BufSize, std::size_t _DataSize >
+    void simd_decode_rounds_scalar( uint *x, std::size_t rounds,
+                                    simd_dec_table< SL, N > const &dt,
+                                    bit_buffer< _BufSize > &src,
+                                    data_block< _DataSize, SL > &dst )
+    {
+      for ( ; rounds > 0u; --rounds )
+      {
+        for ( std::size_t lane = _Lanes; lane > 0u; --lane )
+        {
+          simd_decode_step( x[ lane - 1u ], dt, src, dst );
+        }
+      }
+    }
+
+    // lane shuffles distributing k words read for renormalization to lanes
+    //  selected by mask, lowest word to lowest lane
+    struct simd_refill_tables
+    {
+      constexpr simd_refill_tables() : avx2_perm_p{}, sse_shuffle_p{}
+      {
+        for ( std::size_t m = 0u; m < 256u; ++m )
+        {
+          int rank = 0;
+          for ( std::size_t lane = 0u; lane < 8u; ++lane )
+          {
+            avx2_perm_p[ m ][ lane ] = ( ( m >> lane ) & 1u ) ? rank++ : 0;
+          }
+        }
+        for ( std::size_t m = 0u; m < 16u; ++m )
+        {
+          char rank = 0;
+          for ( std::size_t lane = 0u; lane < 4u; ++lane )
+          {
+            auto set = ( ( m >> lane ) & 1u ) != 0u;
+            sse_shuffle_p[ m ][ 4u * lane + 0u ] =
+              set ? static_cast< char >( 2 * rank ) : char{ -128 };
+            sse_shuffle_p[ m ][ 4u * lane + 1u ] =
+              set ? static_cast< char >( 2 * rank + 1 ) : char{ -128 };
+            sse_shuffle_p[ m ][ 4u * lane + 2u ] = char{ -128 };
+            sse_shuffle_p[ m ][ 4u * lane + 3u ] = char{ -128 };
+            rank = static_cast< char >( rank + ( set ? 1 : 0 ) );
+          }
+        }
+      }
+
+      alignas( 32 ) int avx2_perm_p[ 256 ][ 8 ];
+      alignas( 16 ) char sse_shuffle_p[ 16 ][ 16 ];
+    };
+
+    inline constexpr simd_refill_tables simd_refill{};
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+    template < std::size_t SL, std::size_t N, std::size_t _BufSize,
+               std::size_t _DataSize >
+    __attribute__( ( target( "avx2" ) ) ) void simd_decode_rounds_avx2(
+      uint *x_p, std::size_t rounds, simd_dec_table< SL, N > const &dt,
+      bit_buffer< _BufSize > &src, data_block< _DataSize, SL > &dst )
+    {
+      const auto mask = _mm256_set1_epi32( ( 1 << N ) - 1 );
+      const auto low = _mm256_set1_epi32( 0xffff );
+      const auto sign = _mm256_set1_epi32( std::numeric_limits< int >::min() );
+      const auto bound = _mm256_set1_epi32(
+        std::numeric_limits< int >::min() +
+        static_cast< int >( interleaved_lower_bound ) );
+      auto const *entries = reinterpret_cast< int const * >( dt.entries() );
+
+      auto x = _mm256_loadu_si256( reinterpret_cast< __m256i const * >( x_p ) );
+      alignas( 32 ) uint slots[ 8 ];
+
+      for ( ; rounds > 0u; --rounds )
+      {
+        // table lookup and state update of all lanes
+        auto slot = _mm256_and_si256( x, mask );
+        auto e = _mm256_i32gather_epi32( entries, slot, 4 );
+        auto f = _mm256_and_si256( e, low );
+        auto bias = _mm256_srai_epi32( e, 16 );
+        x = _mm256_add_epi32(
+          _mm256_mullo_epi32( f, _mm256_srli_epi32( x, N ) ),
+          _mm256_sub_epi32( slot, bias ) );
+
+        _mm256_store_si256( reinterpret_cast< __m256i * >( slots ), slot );
+        for ( std::size_t lane = 8u; lane > 0u; --lane )
+        {
+          dst.write_symbol_reverse( dt.symbol( slots[ lane - 1u ] ) );
+        }
+
+        // branchless renormalization of lanes below lower bound
+        auto need =
+          _mm256_cmpgt_epi32( bound, _mm256_xor_si256( x, sign ) );
+        auto m = static_cast< uint >(
+          _mm256_movemask_ps( _mm256_castsi256_ps( need ) ) );
+        src.reverse( static_cast< std::size_t >( __builtin_popcount( m ) )
+                     << 1u );
+        auto words = _mm256_cvtepu16_epi32( _mm_loadu_si128(
+          reinterpret_cast< __m128i const * >( src.curr() ) ) );
+        words = _mm256_permutevar8x32_epi32(
+          words, _mm256_load_si256( reinterpret_cast< __m256i const * >(
+                   simd_refill.avx2_perm_p[ m ] ) ) );
+        x = _mm256_blendv_epi8(
+          x, _mm256_or_si256( _mm256_slli_epi32( x, 16 ), words ), need );
+      }
+
+      _mm256_storeu_si256( reinterpret_cast< __m256i * >( x_p ), x );
+    }
+
+    // lanes are decoded by 4 from highest ones, each group renormalized
+    //  before next one, which reads words in order of scalar decoding
+    template < std::size_t _Lanes, std::size_t SL, std::size_t N,
+               std::size_t _BufSize, std::size_t _DataSize >
+    __attribute__( ( target( "sse4.1" ) ) ) void simd_decode_rounds_sse41(
+      uint *x_p, std::size_t rounds, simd_dec_table< SL, N > const &dt,
+      bit_buffer< _BufSize > &src, data_block< _DataSize, SL > &dst )
+    {
+      constexpr std::size_t groups = _Lanes / 4u;
+
+      const auto mask = _mm_set1_epi32( ( 1 << N ) - 1 );
+      const auto low = _mm_set1_epi32( 0xffff );
+      const auto sign = _mm_set1_epi32( std::numeric_limits< int >::min() );
+      const auto bound =
+        _mm_set1_epi32( std::numeric_limits< int >::min() +
+                        static_cast< int >( interleaved_lower_bound ) );
+      auto const *entries = dt.entries();
+
+      __m128i x_g[ groups ];
+      for ( std::size_t g = 0u; g < groups; ++g )
+      {
+        x_g[ g ] = _mm_loadu_si128(
+          reinterpret_cast< __m128i const * >( x_p + 4u * g ) );
+      }
+      alignas( 16 ) uint slots[ 4 ];
+
+      for ( ; rounds > 0u; --rounds )
+      {
+        for ( std::size_t g = groups; g > 0u; --g )
+        {
+          auto &x = x_g[ g - 1u ];
+
+          // table lookup and state update of lanes of group
+          auto slot = _mm_and_si128( x, mask );
+          _mm_store_si128( reinterpret_cast< __m128i * >( slots ), slot );
+          auto e = _mm_set_epi32( static_cast< int >( entries[ slots[ 3 ] ] ),
+                                  static_cast< int >( entries[ slots[ 2 ] ] ),
+                                  static_cast< int >( entries[ slots[ 1 ] ] ),
+                                  static_cast< int >( entries[ slots[ 0 ] ] ) );
+          auto f = _mm_and_si128( e, low );
+          auto bias = _mm_srai_epi32( e, 16 );
+          x = _mm_add_epi32( _mm_mullo_epi32( f, _mm_srli_epi32( x, N ) ),
+                             _mm_sub_epi32( slot, bias ) );
+
+          for ( std::size_t lane = 4u; lane > 0u; --lane )
+          {
+            dst.write_symbol_reverse( dt.symbol( slots[ lane - 1u ] ) );
+          }
+
+          // branchless renormalization of lanes below lower bound
+          auto need = _mm_cmpgt_epi32( bound, _mm_xor_si128( x, sign ) );
+          auto m = static_cast< uint >(
+            _mm_movemask_ps( _mm_castsi128_ps( need ) ) );
+          src.reverse( static_cast< std::size_t >( __builtin_popcount( m ) )
+                       << 1u );
+          auto words = _mm_shuffle_epi8(
+            _mm_loadl_epi64(
+              reinterpret_cast< __m128i const * >( src.curr() ) ),
+            _mm_load_si128( reinterpret_cast< __m128i const * >(
+              simd_refill.sse_shuffle_p[ m ] ) ) );
+          x = _mm_blendv_epi8(
+            x, _mm_or_si128( _mm_slli_epi32( x, 16 ), words ), need );
+        }
+      }
+
+      for ( std::size_t g = 0u; g < groups; ++g )
+      {
+        _mm_storeu_si128( reinterpret_cast< __m128i * >( x_p + 4u * g ),
+                          x_g[ g ] );
+      }
+    }
+#endif
+  }  // namespace detail
+
+  namespace detail
+  {
+    template < std::size_t _NumBase,
+               template < std::size_t, std::size_t > class _FreqTable,
+               std::size_t _Lanes, bool _Vector, std::size_t _BufSize,
+               std::size_t _DataSize, std::size_t _SymLen >
+    std::chrono::nanoseconds
+    decode_simd_impl( bit_buffer< _BufSize > &src,
+                      data_block< _DataSize, _SymLen > &dst )
+    {
+      static_assert( _Lanes == 4u || _Lanes == 8u,
+                     "supported lane counts: 4 (SSE4.1), 8 (AVX2)" );
+
+      // start decoding
+      auto start_time = std::chrono::high_resolution_clock::now();
+
+      // decode frequency table, symbol count and final states from input
+      auto ft = _FreqTable< _SymLen, _NumBase >::read_header_reverse( src );
+      auto dt = simd_dec_table< _SymLen, _NumBase >( ft );
+
+      uint count = 0u;
+      src.read_reverse( sizeof( uint ), &count );
+      auto n = static_cast< std::size_t >( count );
+
+      alignas( 32 ) uint x[ _Lanes ];
+      for ( std::size_t lane = _Lanes; lane > 0u; --lane )
+      {
+        src.read_reverse( sizeof( uint ), &x[ lane - 1u ] );
+      }
+
+      if ( !dst.prepare( n ) )
+      {
+        std::printf( "Decoded block too small for %lu symbols.\n", n );
+        return std::chrono::nanoseconds{};
+      }
+
+      // ---------------
+
+      // trailing partial round is decoded lane by lane
+      auto i = n;
+      while ( ( i & ( _Lanes - 1u ) ) != 0u )
+      {
+        --i;
+        simd_decode_step( x[ i & ( _Lanes - 1u ) ], dt, src, dst );
+      }
+
+      auto rounds = i / _Lanes;
+      switch ( _Vector ? simd_kernel_for( _Lanes ) : simd_kernel::scalar )
+      {
+#if defined( __x86_64__ ) || defined( __i386__ )
+      case simd_kernel::avx2:
+        if constexpr ( _Lanes == 8u )
+        {
+          simd_decode_rounds_avx2( x, rounds, dt, src, dst );
+        }
+        break;
+      case simd_kernel::sse41:
+        simd_decode_rounds_sse41< _Lanes >( x, rounds, dt, src, dst );
+        break;
+#endif
+      default:
+        simd_decode_rounds_scalar< _Lanes >( x, rounds, dt, src, dst );
+        break;
+      }
+
+      // ---------------
+
+      // end decoding
+      return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::high_resolution_clock::now() - start_time );
+    }
+  }  // namespace detail
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  std::chrono::nanoseconds decode_simd( bit_buffer< _BufSize > &src,
+                                        data_block< _DataSize, _SymLen > &dst )
+  {
+    return detail::decode_simd_impl< _NumBase, _FreqTable, _Lanes, true >(
+      src, dst );
+  }
+
+  // scalar decoder of the same streams with identical output
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _Lanes, std::size_t _BufSize, std::size_t _DataSize,
+             std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_simd_fallback( bit_buffer< _BufSize > &src,
+                        data_block< _DataSize, _SymLen > &dst )
+  {
+    return detail::decode_simd_impl< _NumBase, _FreqTable, _Lanes, false >(
+      src, dst );
+  }
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_SIMD_H_INCLUDED
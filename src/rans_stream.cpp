@@ -0,0 +1,27 @@
+#include "rans_stream.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace coding::rans
+{
+  std::size_t fd_reader::operator()( void *dst_p, std::size_t n )
+  {
+    while ( true )
+    {
+      auto bytes = ::read( m_fd, dst_p, n );
+      if ( bytes >= 0 )
+      {
+        return static_cast< std::size_t >( bytes );
+      }
+      if ( errno != EINTR )
+      {
+        throw std::system_error( errno, std::generic_category(),
+                                 "rANS stream read" );
+      }
+    }
+  }
+
+}  // namespace coding::rans
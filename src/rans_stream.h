@@ -0,0 +1,319 @@
+#ifndef CODING_RANS_STREAM_H_INCLUDED
+#define CODING_RANS_STREAM_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "bit_buffer.h"
+#include "compr_stats.h"
+#include "data_block.h"
+#include "word_io.h"
+
+namespace coding::rans
+{
+
+  // forward-readable rANS; encoder walks symbols back to front and emits
+  //  renormalization words in reverse, so that decoder reads everything
+  //  strictly front to back and can consume stream incrementally; state
+  //  lives in [L, 2^32) with L = 2^16 and is renormalized 16 bits at a time
+  //
+  // stream layout (read front to back by the decoder):
+  //  [header length][header][symbol count][final state][renormalization words]
+  // header length, symbol count and state are uint
+
+  namespace detail
+  {
+    constexpr ulong forward_lower_bound = 1ul << 16ul;
+    constexpr ulong forward_word_mask = ( 1ul << 16ul ) - 1ul;
+  }  // namespace detail
+
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  compr_stats< _SymLen > encode_forward( data_block< _DataSize, _SymLen > &src,
+                                         bit_buffer< _BufSize > &dst )
+  {
+    static_assert( _NumBase <= 15u, "numeral base too large for 32-bit state" );
+
+    auto stats = compr_stats< _SymLen >{};
+
+    // start encoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // compute frequency table from data block
+    auto ft = _FreqTable< _SymLen, _NumBase >( src );
+
+    // ---------------
+
+    const ulong MASK = detail::forward_word_mask;
+    const ulong d = 32 - _NumBase;
+    const auto n = src.symbol_count();
+
+    // words are collected in order of emission and written reversed
+    auto words = std::vector< word >{};
+    words.reserve( ( n * _SymLen >> 4u ) + 2u );
+
+    ulong x = detail::forward_lower_bound;
+    src.fast_forward();
+    sym_word< _SymLen > span_p[ unpacked_span_size ];
+    for ( auto left = n; left > 0u; )
+    {
+      auto k = std::min( left, unpacked_span_size );
+      src.read_symbols_reverse( span_p, k );
+      left -= k;
+      for ( auto j = k; j > 0u; --j )
+      {
+        auto s = span_p[ j - 1u ];
+        if ( x >= ( static_cast< ulong >( ft.f( s ) ) << d ) )
+        {
+          words.push_back( static_cast< word >( x & MASK ) );
+          x >>= 16ul;
+        }
+        x = ( ( x / static_cast< ulong >( ft.f( s ) ) ) << _NumBase ) +
+            ft.rans_encode_adjust( s, x );
+      }
+    }
+    src.rewind();
+
+    dst.write_value( static_cast< uint >( ft.header_length() >> 3u ) );
+    ft.write_header( dst );
+    dst.write_value( static_cast< uint >( n ) );
+    dst.write_value( static_cast< uint >( x ) );
+
+    auto *words_p = dst.claim( words.size() * sizeof( word ) );
+    for ( std::size_t i = words.size(); i > 0u; --i )
+    {
+      std::memcpy( words_p, &words[ i - 1u ], sizeof( word ) );
+      words_p += sizeof( word );
+    }
+
+    // ---------------
+
+    // end encoding
+    auto encoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    // write current run stats
+    stats.set_header_length( ft.header_length() );
+    stats.set_symbol_count( ft.symbol_count() );
+    stats.set_bits_per_symbol_theory( ft.bits_per_symbol_theory() );
+    stats.set_encoded_length( dst.length() );
+    stats.set_encoding_time( encoding_time );
+
+    return stats;
+  }
+
+  // decodes forward stream starting at cursor of src, appending symbols to dst
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _BufSize, std::size_t _DataSize, std::size_t _SymLen >
+  std::chrono::nanoseconds
+  decode_forward( bit_buffer< _BufSize > &src,
+                  data_block< _DataSize, _SymLen > &dst )
+  {
+    // start decoding
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // decode frequency table, symbol count and initial state
+    src.advance( sizeof( uint ) );
+    auto ft = _FreqTable< _SymLen, _NumBase >( src );
+    uint count = 0u;
+    src.read( sizeof( uint ), &count );
+    uint state = 0u;
+    src.read( sizeof( uint ), &state );
+
+    // ---------------
+
+    auto mask = static_cast< ulong >( ft.num_mask() );
+    auto x = static_cast< ulong >( state );
+    auto in = word_reader< _BufSize, word >( src );
+
+    sym_word< _SymLen > span_p[ unpacked_span_size ];
+    for ( std::size_t left = count; left > 0u; )
+    {
+      auto k = std::min( left, unpacked_span_size );
+      for ( std::size_t j = 0u; j < k; ++j )
+      {
+        auto slot = x & mask;
+        auto s = ft.symbol( static_cast< word >( slot ) );
+        span_p[ j ] = s;
+        auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, slot );
+        x = ( f * ( x >> _NumBase ) ) + slot - cdf;
+        if ( x < detail::forward_lower_bound )
+        {
+          x = ( x << 16ul ) + static_cast< ulong >( in.read_value() );
+        }
+      }
+      dst.write_symbols( span_p, k );
+      left -= k;
+    }
+    in.release();
+
+    // ---------------
+
+    // end decoding
+    auto decoding_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+      std::chrono::high_resolution_clock::now() - start_time );
+
+    return decoding_time;
+  }
+
+  // reader of raw bytes from file descriptor ( e.g. file, pipe or socket );
+  //  failures are reported with std::system_error
+  class fd_reader
+  {
+  public:
+    explicit fd_reader( int fd ) noexcept : m_fd( fd ) {}
+
+    // reads up to n bytes, returns 0 only at end of input
+    std::size_t operator()( void *dst_p, std::size_t n );
+
+  private:
+    int m_fd;
+  };
+
+  // decoder of forward stream pulling input incrementally from reader; memory
+  //  use is bounded by input buffer of _BufSize bytes and frequency table
+  template < std::size_t _NumBase,
+             template < std::size_t, std::size_t > class _FreqTable,
+             std::size_t _SymLen, std::size_t _BufSize = 64u * 1024u >
+  class stream_decoder
+  {
+  public:
+    static_assert( _BufSize >= 2u * sizeof( uint ), "input buffer too small" );
+
+    // reads up to n bytes into given memory, returns 0 only at end of input
+    using reader_type = std::function< std::size_t( void *, std::size_t ) >;
+
+    using table_type = _FreqTable< _SymLen, _NumBase >;
+
+    // reads header, symbol count and initial state
+    explicit stream_decoder( reader_type reader ) :
+      m_reader( std::move( reader ) )
+    {
+      uint header_size = 0u;
+      read( sizeof( uint ), &header_size );
+
+      auto header = bit_buffer< dynamic_size >( header_size );
+      read( header_size, header.claim( header_size ) );
+      header.rewind();
+      m_table = table_type( header );
+
+      uint count = 0u;
+      read( sizeof( uint ), &count );
+      m_remaining = count;
+      uint state = 0u;
+      read( sizeof( uint ), &state );
+      m_state = state;
+    }
+
+    stream_decoder( stream_decoder const & ) = delete;
+    stream_decoder &operator=( stream_decoder const & ) = delete;
+
+    table_type const &table() const noexcept { return m_table; }
+
+    // symbols not decoded yet
+    std::size_t remaining() const noexcept { return m_remaining; }
+
+    operator bool() const noexcept { return m_remaining > 0u; }
+
+    // appends up to max_count next symbols to dst, returns their number
+    template < std::size_t _DataSize >
+    std::size_t decode( data_block< _DataSize, _SymLen > &dst,
+                        std::size_t max_count )
+    {
+      auto n = std::min( max_count, m_remaining );
+      auto mask = static_cast< ulong >( m_table.num_mask() );
+      auto x = m_state;
+
+      sym_word< _SymLen > span_p[ unpacked_span_size ];
+      for ( auto left = n; left > 0u; )
+      {
+        auto k = std::min( left, unpacked_span_size );
+        for ( std::size_t j = 0u; j < k; ++j )
+        {
+          auto slot = x & mask;
+          auto s = m_table.symbol( static_cast< word >( slot ) );
+          span_p[ j ] = s;
+          auto [ f, cdf ] = m_table.adjusted_f_and_cdf( s, slot );
+          x = ( f * ( x >> _NumBase ) ) + slot - cdf;
+          if ( x < detail::forward_lower_bound )
+          {
+            x = ( x << 16ul ) + static_cast< ulong >( read_word() );
+          }
+        }
+        dst.write_symbols( span_p, k );
+        left -= k;
+      }
+
+      m_state = x;
+      m_remaining -= n;
+      return n;
+    }
+
+  private:
+    word read_word()
+    {
+      if ( m_end - m_pos < sizeof( word ) )
+      {
+        refill( sizeof( word ) );
+      }
+      word result;
+      std::memcpy( &result, m_buffer_p + m_pos, sizeof( word ) );
+      m_pos += sizeof( word );
+      return result;
+    }
+
+    void read( std::size_t n, void *dst_p )
+    {
+      auto *out_p = static_cast< byte * >( dst_p );
+      while ( n > 0u )
+      {
+        if ( m_pos == m_end )
+        {
+          refill( 1u );
+        }
+        auto chunk = std::min( n, m_end - m_pos );
+        std::memcpy( out_p, m_buffer_p + m_pos, chunk );
+        m_pos += chunk;
+        out_p += chunk;
+        n -= chunk;
+      }
+    }
+
+    // keeps unread bytes and reads until at least n bytes are available
+    void refill( std::size_t n )
+    {
+      std::memmove( m_buffer_p, m_buffer_p + m_pos, m_end - m_pos );
+      m_end -= m_pos;
+      m_pos = 0u;
+      while ( m_end < n )
+      {
+        auto bytes = m_reader( m_buffer_p + m_end, _BufSize - m_end );
+        if ( bytes == 0u )
+        {
+          throw std::runtime_error( "rANS stream ended unexpectedly" );
+        }
+        m_end += bytes;
+      }
+    }
+
+  private:
+    reader_type m_reader;
+    table_type m_table;
+    ulong m_state = 0u;
+    std::size_t m_remaining = 0u;
+    byte m_buffer_p[ _BufSize ];
+    std::size_t m_pos = 0u;
+    std::size_t m_end = 0u;
+  };
+
+}  // namespace coding::rans
+
+#endif  // !CODING_RANS_STREAM_H_INCLUDED
@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace coding
+{
+  thread_pool::thread_pool( std::size_t thread_count )
+  {
+    if ( thread_count == 0u )
+    {
+      thread_count = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+
+    m_threads.reserve( thread_count );
+    for ( std::size_t i = 0u; i < thread_count; ++i )
+    {
+      m_threads.emplace_back( [ this ]() noexcept { work(); } );
+    }
+  }
+
+  thread_pool::~thread_pool() noexcept
+  {
+    {
+      auto lock = std::lock_guard< std::mutex >( m_mutex );
+      m_stop = true;
+    }
+    m_job_ready.notify_all();
+
+    for ( auto &thread : m_threads )
+    {
+      thread.join();
+    }
+  }
+
+  void thread_pool::run_job( std::size_t count, void const *task_p,
+                             invoke_type invoke )
+  {
+    if ( count == 0u )
+    {
+      return;
+    }
+
+    // workers woken late for previous job must leave it first
+    auto lock = std::unique_lock< std::mutex >( m_mutex );
+    m_job_done.wait( lock, [ this ] { return m_busy == 0u; } );
+    m_task_p = task_p;
+    m_invoke = invoke;
+    m_count = count;
+    m_next.store( 0u, std::memory_order_relaxed );
+    m_error = nullptr;
+    ++m_generation;
+    m_job_ready.notify_all();
+
+    // job is finished once all indices are taken and no worker is busy
+    m_job_done.wait( lock, [ this ] {
+      return m_busy == 0u &&
+             m_next.load( std::memory_order_relaxed ) >= m_count;
+    } );
+    m_task_p = nullptr;
+    m_invoke = nullptr;
+
+    if ( m_error )
+    {
+      std::rethrow_exception( std::exchange( m_error, nullptr ) );
+    }
+  }
+
+  void thread_pool::work() noexcept
+  {
+    ulong generation = 0u;
+    auto lock = std::unique_lock< std::mutex >( m_mutex );
+    while ( true )
+    {
+      m_job_ready.wait(
+        lock, [ & ] { return m_stop || m_generation != generation; } );
+      if ( m_stop )
+      {
+        return;
+      }
+      generation = m_generation;
+
+      ++m_busy;
+      lock.unlock();
+      work_job();
+      lock.lock();
+      --m_busy;
+
+      if ( m_busy == 0u )
+      {
+        m_job_done.notify_all();
+      }
+    }
+  }
+
+  void thread_pool::work_job() noexcept
+  {
+    while ( true )
+    {
+      auto i = m_next.fetch_add( 1u, std::memory_order_relaxed );
+      if ( i >= m_count )
+      {
+        return;
+      }
+
+      try
+      {
+        m_invoke( m_task_p, i );
+      }
+      catch ( ... )
+      {
+        auto lock = std::lock_guard< std::mutex >( m_mutex );
+        if ( !m_error )
+        {
+          m_error = std::current_exception();
+        }
+      }
+    }
+  }
+
+}  // namespace coding
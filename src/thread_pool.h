@@ -0,0 +1,66 @@
+#ifndef CODING_THREAD_POOL_H_INCLUDED
+#define CODING_THREAD_POOL_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+
+namespace coding
+{
+  // fixed set of worker threads running indexed tasks of one job at a time
+  class thread_pool
+  {
+  public:
+    // zero selects one thread per hardware thread
+    explicit thread_pool( std::size_t thread_count = 0u );
+    thread_pool( thread_pool const & ) = delete;
+    thread_pool( thread_pool && ) = delete;
+    thread_pool &operator=( thread_pool const & ) = delete;
+    thread_pool &operator=( thread_pool && ) = delete;
+    ~thread_pool() noexcept;
+
+    std::size_t size() const noexcept { return m_threads.size(); }
+
+    // runs task( i ) for every i in [0, count) and waits for completion;
+    //  first exception thrown by any task is rethrown
+    template < typename _Task >
+    void run( std::size_t count, _Task const &task )
+    {
+      run_job( count, static_cast< void const * >( &task ),
+               []( void const *task_p, std::size_t i ) {
+                 ( *static_cast< _Task const * >( task_p ) )( i );
+               } );
+    }
+
+  private:
+    using invoke_type = void ( * )( void const *, std::size_t );
+
+    void run_job( std::size_t count, void const *task_p, invoke_type invoke );
+    void work() noexcept;
+    void work_job() noexcept;
+
+  private:
+    std::vector< std::thread > m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_job_ready;
+    std::condition_variable m_job_done;
+
+    // current job; changed only while no worker is busy
+    void const *m_task_p = nullptr;
+    invoke_type m_invoke = nullptr;
+    std::size_t m_count = 0u;
+    std::atomic< std::size_t > m_next{ 0u };
+    std::size_t m_busy = 0u;
+    ulong m_generation = 0u;
+    std::exception_ptr m_error;
+    bool m_stop = false;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_THREAD_POOL_H_INCLUDED
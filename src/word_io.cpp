@@ -0,0 +1,5 @@
+#include "word_io.h"
+
+namespace coding
+{
+}  // namespace coding
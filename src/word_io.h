@@ -0,0 +1,259 @@
+#ifndef CODING_WORD_IO_H_INCLUDED
+#define CODING_WORD_IO_H_INCLUDED
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "bit_buffer.h"
+#include "common.h"
+
+namespace coding
+{
+  // bytes claimed from bit buffer at once by word_writer
+  constexpr std::size_t word_batch_size = 4096u;
+
+  // writer of renormalization words for coder hot loops; words are staged in
+  //  64-bit register and stored 8 bytes at a time into room claimed from
+  //  buffer in batches, so that capacity is checked once per batch; produces
+  //  same bytes as write_value< _Word >() calls and must be flushed before
+  //  buffer is used directly again
+  template < std::size_t _BufSize, typename _Word >
+  class word_writer
+  {
+  public:
+    static constexpr std::size_t word_bits = sizeof( _Word ) << 3u;
+    static_assert( 64u % word_bits == 0u, "word must divide 64 bits" );
+
+    explicit word_writer( bit_buffer< _BufSize > &dst ) noexcept : m_dst( dst )
+    {
+    }
+
+    word_writer( word_writer const & ) = delete;
+    word_writer &operator=( word_writer const & ) = delete;
+
+    void write_value( _Word value )
+    {
+      m_stage |= static_cast< ulong >( value ) << m_bits;
+      m_bits += word_bits;
+      if ( m_bits == 64u )
+      {
+        if ( m_out_p == m_limit_p )
+        {
+          claim_batch( sizeof( ulong ) );
+        }
+        std::memcpy( m_out_p, &m_stage, sizeof( ulong ) );
+        m_out_p += sizeof( ulong );
+        m_stage = 0u;
+        m_bits = 0u;
+      }
+    }
+
+    // stores staged words and gives back unused room of batch
+    void flush()
+    {
+      auto n = m_bits >> 3u;
+      if ( n > 0u )
+      {
+        if ( static_cast< std::size_t >( m_limit_p - m_out_p ) < n )
+        {
+          claim_batch( n );
+        }
+        std::memcpy( m_out_p, &m_stage, n );
+        m_out_p += n;
+        m_stage = 0u;
+        m_bits = 0u;
+      }
+      m_dst.release( static_cast< std::size_t >( m_limit_p - m_out_p ) );
+      m_out_p = nullptr;
+      m_limit_p = nullptr;
+    }
+
+  private:
+    // room of current batch is given back before next one is claimed, so
+    //  that batches stay contiguous
+    void claim_batch( std::size_t n )
+    {
+      m_dst.release( static_cast< std::size_t >( m_limit_p - m_out_p ) );
+      auto size = word_batch_size;
+      if constexpr ( _BufSize != dynamic_size )
+      {
+        // full stores need whole 8 bytes of room
+        size = std::min( size, m_dst.max_size() - m_dst.size() );
+        if ( n == sizeof( ulong ) )
+        {
+          size &= ~( sizeof( ulong ) - 1u );
+        }
+        if ( size < n )
+        {
+          throw std::length_error( "bit buffer full" );
+        }
+      }
+      m_out_p = m_dst.claim( size );
+      m_limit_p = m_out_p + size;
+    }
+
+  private:
+    bit_buffer< _BufSize > &m_dst;
+    byte *m_out_p = nullptr;
+    byte *m_limit_p = nullptr;
+    ulong m_stage = 0u;
+    std::size_t m_bits = 0u;
+  };
+
+  // reader of words front to back, refilled with 8 bytes at once; range is
+  //  checked once per refill and words past end of buffer read as zeros;
+  //  release() moves cursor of buffer past consumed words
+  template < std::size_t _BufSize, typename _Word >
+  class word_reader
+  {
+  public:
+    static constexpr std::size_t word_bits = sizeof( _Word ) << 3u;
+    static_assert( 64u % word_bits == 0u, "word must divide 64 bits" );
+
+    explicit word_reader( bit_buffer< _BufSize > &src ) noexcept :
+      m_src( src ),
+      m_curr_p( src.curr() ),
+      m_end_p( src.data() + src.size() )
+    {
+    }
+
+    word_reader( word_reader const & ) = delete;
+    word_reader &operator=( word_reader const & ) = delete;
+
+    _Word read_value() noexcept
+    {
+      if ( m_bits == 0u )
+      {
+        refill();
+      }
+      auto result = static_cast< _Word >( m_stage );
+      m_stage >>= word_bits;
+      m_bits -= word_bits;
+      return result;
+    }
+
+    void release() noexcept
+    {
+      auto consumed = static_cast< std::size_t >( m_curr_p - m_src.curr() );
+      m_src.advance( consumed - std::min( m_bits >> 3u, m_loaded ) );
+      m_curr_p = m_src.curr();
+      m_stage = 0u;
+      m_bits = 0u;
+      m_loaded = 0u;
+    }
+
+  private:
+    void refill() noexcept
+    {
+      ulong stage = 0u;
+      auto n = sizeof( ulong );
+      if ( m_end_p - m_curr_p >= static_cast< std::ptrdiff_t >( n ) )
+      {
+        std::memcpy( &stage, m_curr_p, sizeof( ulong ) );
+      }
+      else
+      {
+        n = static_cast< std::size_t >( m_end_p - m_curr_p );
+        n -= n % sizeof( _Word );
+        std::memcpy( &stage, m_curr_p, n );
+      }
+      m_stage = stage;
+      m_curr_p += n;
+      m_loaded = n;
+      // zero word is staged past end
+      m_bits = std::max( n << 3u, word_bits );
+    }
+
+  private:
+    bit_buffer< _BufSize > &m_src;
+    byte const *m_curr_p;
+    byte const *m_end_p;
+    ulong m_stage = 0u;
+    std::size_t m_bits = 0u;
+    std::size_t m_loaded = 0u;
+  };
+
+  // reader of words back to front from cursor, drop-in for
+  //  read_value_reverse< _Word >() and is_beg() of legacy rANS decoder;
+  //  release() moves cursor of buffer before consumed words
+  template < std::size_t _BufSize, typename _Word >
+  class word_reader_reverse
+  {
+  public:
+    static constexpr std::size_t word_bits = sizeof( _Word ) << 3u;
+    static_assert( 64u % word_bits == 0u, "word must divide 64 bits" );
+
+    explicit word_reader_reverse( bit_buffer< _BufSize > &src ) noexcept :
+      m_src( src ),
+      m_beg_p( src.data() ),
+      m_curr_p( src.curr() )
+    {
+    }
+
+    word_reader_reverse( word_reader_reverse const & ) = delete;
+    word_reader_reverse &operator=( word_reader_reverse const & ) = delete;
+
+    // stray bytes shorter than word before first word are not read
+    bool is_beg() const noexcept
+    {
+      return m_bits == 0u &&
+             static_cast< std::size_t >( m_curr_p - m_beg_p ) <
+               sizeof( _Word );
+    }
+
+    // last staged word is kept in top bits
+    _Word read_value_reverse() noexcept
+    {
+      if ( m_bits == 0u )
+      {
+        refill();
+      }
+      auto result = static_cast< _Word >( m_stage >> ( 64u - word_bits ) );
+      m_stage <<= word_bits;
+      m_bits -= word_bits;
+      return result;
+    }
+
+    void release() noexcept
+    {
+      auto consumed = static_cast< std::size_t >( m_src.curr() - m_curr_p );
+      m_src.reverse( consumed - ( m_bits >> 3u ) );
+      m_curr_p = m_src.curr();
+      m_stage = 0u;
+      m_bits = 0u;
+    }
+
+  private:
+    void refill() noexcept
+    {
+      ulong stage = 0u;
+      auto n = sizeof( ulong );
+      if ( m_curr_p - m_beg_p >= static_cast< std::ptrdiff_t >( n ) )
+      {
+        m_curr_p -= n;
+        std::memcpy( &stage, m_curr_p, sizeof( ulong ) );
+      }
+      else
+      {
+        n = static_cast< std::size_t >( m_curr_p - m_beg_p );
+        n -= n % sizeof( _Word );
+        m_curr_p -= n;
+        std::memcpy( reinterpret_cast< byte * >( &stage ) + 8u - n, m_curr_p,
+                     n );
+      }
+      m_stage = stage;
+      m_bits = n << 3u;
+    }
+
+  private:
+    bit_buffer< _BufSize > &m_src;
+    byte const *m_beg_p;
+    byte const *m_curr_p;
+    ulong m_stage = 0u;
+    std::size_t m_bits = 0u;
+  };
+
+}  // namespace coding
+
+#endif  // !CODING_WORD_IO_H_INCLUDED
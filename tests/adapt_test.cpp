@@ -1,9 +1,22 @@
 #include "data_block.h"
+#include "num_freq_table_lookup.h"
 #include "num_freq_table_adapt.h"
+#include "rans_adaptive.h"
+#include "rans_stream.h"
 
 #include <cstdio>
+#include <fstream>
 
-void num_freq_table_adapt_test()
+constexpr std::size_t NUM = 12;
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+// history of probabilities ( one row per symbol ) is written only if path
+//  is given, cf. results/adaptive-plot.py
+void num_freq_table_adapt_test( char const *history_path )
 {
   auto buf = coding::data_block< 1024, 2 >( "LICENSE" );
 
@@ -17,13 +30,108 @@ void num_freq_table_adapt_test()
     std::printf( "Identity error!" );
   }
 
+  if ( history_path != nullptr )
+  {
+    auto fout = std::ofstream( history_path );
+    auto hft = coding::num_freq_table_adapt< 2, 12, 3 >();
+    while ( buf )
+    {
+      hft.update( buf.read_symbol() );
+      for ( std::size_t i = 0u; i < hft.size(); ++i )
+      {
+        fout << hft.p( i ) << "\t";
+      }
+      fout << "\n";
+    }
+    buf.rewind();
+  }
+
   std::printf( "\n" );
 }
 
+// static model of forward layout for comparison
+template < std::size_t SL >
+void rans_static_test( block_t< SL > &data )
+{
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  auto stats =
+    coding::rans::encode_forward< NUM, coding::num_freq_table_lookup >( data,
+                                                                        bits );
+  bits.rewind();
+  stats.set_decoding_time(
+    coding::rans::decode_forward< NUM, coding::num_freq_table_lookup >(
+      bits, dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+  stats.display( "rANS (static)" );
 
-int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+  std::printf( "\n\n" );
+}
+
+template < std::size_t SL, std::size_t RATE >
+void rans_adaptive_test( char const *filepath )
 {
-  num_freq_table_adapt_test();
+  std::printf( "=== rANS ADAPTIVE TEST (SL = %lu, RATE = %lu, %s) ===\n\n", SL,
+               RATE, filepath );
+
+  auto data = block_t< SL >( filepath );
+
+  // adaptive model
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  auto stats = coding::rans::encode_adaptive< NUM, RATE >( data, bits );
+  bits.rewind();
+  stats.set_decoding_time(
+    coding::rans::decode_adaptive< NUM, RATE >( bits, dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+  stats.display( "rANS (adaptive)" );
+  std::printf( "\n" );
+
+  rans_static_test( data );
+}
+
+// adapting to data changing in the middle
+void rans_adaptive_shift_test()
+{
+  std::printf( "=== rANS ADAPTIVE TEST (SL = 8, shifting source) ===\n\n" );
+
+  auto data = block_t< 8 >( 1u << 16u );
+  for ( std::size_t i = 0u; i < ( 1u << 16u ); ++i )
+  {
+    auto base = i < ( 1u << 15u ) ? 'a' : 'A';
+    data.write_symbol( static_cast< coding::byte >( base + ( i * i ) % 5u ) );
+  }
+  data.rewind();
+
+  auto bits = buffer_t();
+  auto dout = block_t< 8 >();
+  auto stats = coding::rans::encode_adaptive< NUM, 5 >( data, bits );
+  bits.rewind();
+  stats.set_decoding_time(
+    coding::rans::decode_adaptive< NUM, 5 >( bits, dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+  stats.display( "rANS (adaptive)" );
+  std::printf( "\n" );
+
+  rans_static_test( data );
+}
+
+int main( int argc, char const *argv[] )
+{
+  num_freq_table_adapt_test( argc > 1 ? argv[ 1 ] : nullptr );
+
+  rans_adaptive_test< 1, 4 >( "LICENSE" );
+  rans_adaptive_test< 2, 4 >( "LICENSE" );
+  rans_adaptive_test< 4, 5 >( "LICENSE" );
+  rans_adaptive_test< 8, 5 >( "LICENSE" );
+  rans_adaptive_test< 8, 5 >( ".clang-tidy" );
+  rans_adaptive_shift_test();
 
   return 0;
 }
@@ -1,10 +1,22 @@
 #include "bit_buffer.h"
 #include "compr_stats.h"
 #include "data_block.h"
+#include "freq_normalize.h"
 #include "freq_table.h"
+#include "histogram.h"
+#include "mapped_file.h"
 #include "num_freq_table.h"
+#include "word_io.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <vector>
 
 void bit_buffer_test()
 {
@@ -124,6 +136,60 @@ void data_block_file_test()
   std::printf( "\n" );
 }
 
+void mapped_file_test()
+{
+  std::printf( "MAPPED FILE TEST:\n\n" );
+
+  auto file = coding::mapped_file( "LICENSE" );
+  auto view = file.view< 4 >();
+  static_assert( std::is_same_v< decltype( view.data() ), coding::byte const * >,
+                 "mapped view is read-only" );
+  auto loaded = coding::data_block< coding::dynamic_size, 4 >( "LICENSE" );
+  auto small = coding::data_block< 128, 4 >();
+  auto complete = small.load( "LICENSE" );
+
+  std::printf( "Mapped size: %lu bytes.\n", file.size() );
+  std::printf( "Mapped view matches loaded block: %s.\n",
+               ( view == loaded ) ? "OK" : "FAILED" );
+  std::printf( "Truncated load reported: %s.\n",
+               ( !complete && small.size() == 128u ) ? "OK" : "FAILED" );
+
+  auto num_ft = coding::num_freq_table< 4, 12 >( view );
+  auto loaded_num_ft = coding::num_freq_table< 4, 12 >( loaded );
+  std::printf( "Frequency table from mapped view: %s.\n",
+               ( num_ft == loaded_num_ft ) ? "OK" : "FAILED" );
+
+  try
+  {
+    auto missing = coding::mapped_file( "missing-file" );
+    std::printf( "Missing file reported: FAILED.\n" );
+  }
+  catch ( std::system_error const &e )
+  {
+    std::printf( "Missing file reported: OK (%s).\n", e.what() );
+  }
+
+  try
+  {
+    auto dir = coding::data_block< coding::dynamic_size, 8 >( "src" );
+    std::printf( "Directory load reported: FAILED.\n" );
+  }
+  catch ( std::system_error const &e )
+  {
+    std::printf( "Directory load reported: %s (%s).\n",
+                 e.code() == std::errc::is_a_directory ? "OK" : "FAILED",
+                 e.what() );
+  }
+
+  // procfs reports zero size, so file is read in growing chunks
+  auto status = coding::data_block< coding::dynamic_size, 8 >();
+  auto status_complete = status.load( "/proc/self/status" );
+  std::printf( "Load of file with unknown size: %s.\n",
+               ( status_complete && status.size() > 0u ) ? "OK" : "FAILED" );
+
+  std::printf( "\n" );
+}
+
 void freq_table_test()
 {
   auto buf = coding::data_block< 1024, 4 >( "LICENSE" );
@@ -205,6 +271,361 @@ void num_freq_table_test()
   std::printf( "\n" );
 }
 
+void freq_normalize_test()
+{
+  std::printf( "FREQUENCY NORMALIZATION TEST:\n\n" );
+
+  // skewed counts with rare symbols, which plain scaling rounds to 0
+  coding::uint counts_p[ 16 ] = { 900000u, 50000u, 30000u, 12000u, 5000u,
+                                  2000u,   700u,   200u,   90u,    7u,
+                                  1u,      1u,     1u,     0u,     0u,
+                                  1u };
+  coding::uint freqs_p[ 16 ];
+  std::copy( counts_p, counts_p + 16, freqs_p );
+  coding::normalize_freqs( freqs_p, 16u, 1u << 12u );
+
+  coding::ulong total = 0u;
+  coding::uint sum = 0u;
+  auto ok = true;
+  for ( std::size_t i = 0; i < 16; ++i )
+  {
+    total += counts_p[ i ];
+    sum += freqs_p[ i ];
+    ok = ok && ( counts_p[ i ] == 0u ) == ( freqs_p[ i ] == 0u );
+  }
+
+  double bits = 0.0;
+  std::printf( " S    count     f(S)\n" );
+  for ( std::size_t i = 0; i < 16; ++i )
+  {
+    std::printf( " %02x %8u %8u\n", static_cast< unsigned >( i ),
+                 counts_p[ i ], freqs_p[ i ] );
+    if ( counts_p[ i ] != 0u )
+    {
+      bits -= static_cast< double >( counts_p[ i ] ) *
+              std::log2( static_cast< double >( freqs_p[ i ] ) / 4096.0 );
+    }
+  }
+  std::printf( "\nBits/symbol (coded): %10.4f\n",
+               bits / static_cast< double >( total ) );
+  std::printf( "Normalization check: %s.\n\n",
+               ( ok && sum == 4096u ) ? "OK" : "FAILED" );
+}
+
+// histogram from cursor compared to counting one symbol at a time
+template < std::size_t SL >
+bool histogram_check( coding::data_block< coding::dynamic_size, SL > &data,
+                      std::size_t skip, coding::thread_pool &pool )
+{
+  data.rewind();
+  for ( std::size_t i = 0u; i < skip; ++i )
+  {
+    data.read_symbol();
+  }
+  auto pos = data.get_position();
+
+  coding::uint counts_p[ 1u << SL ] = {};
+  coding::uint pool_counts_p[ 1u << SL ] = {};
+  coding::uint naive_p[ 1u << SL ] = {};
+  auto count = coding::count_symbols( data, counts_p );
+  auto pool_count = coding::count_symbols( data, pool_counts_p, pool );
+  std::size_t naive_count = 0u;
+  while ( data )
+  {
+    ++naive_p[ data.read_symbol() ];
+    ++naive_count;
+  }
+  data.set_position( pos );
+
+  auto ok = count == naive_count && pool_count == naive_count &&
+            data.get_position() == pos;
+  for ( std::size_t i = 0u; i < ( 1u << SL ); ++i )
+  {
+    ok = ok && counts_p[ i ] == naive_p[ i ] &&
+         pool_counts_p[ i ] == naive_p[ i ];
+  }
+  return ok;
+}
+
+void histogram_test()
+{
+  std::printf( "HISTOGRAM TEST:\n\n" );
+
+  // runs of repeated bytes mixed with random ones
+  const std::size_t size = 4u * 1024u * 1024u + 5u;
+  auto bytes = coding::data_block< coding::dynamic_size, 8 >( size );
+  coding::uint seed = 2463534242u;
+  for ( std::size_t i = 0u; i < size; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    bytes.write_symbol( ( i & 4096u ) != 0u
+                          ? coding::byte{ 'a' }
+                          : static_cast< coding::byte >( seed >> 24u ) );
+  }
+
+  auto pool = coding::thread_pool( 4u );
+  auto view1 = coding::data_block< coding::dynamic_size, 1 >( bytes.data(),
+                                                               size );
+  auto view2 = coding::data_block< coding::dynamic_size, 2 >( bytes.data(),
+                                                               size );
+  auto view4 = coding::data_block< coding::dynamic_size, 4 >( bytes.data(),
+                                                               size );
+  auto view3 = coding::data_block< coding::dynamic_size, 3 >( bytes.data(),
+                                                               4096u );
+  auto view12 = coding::data_block< coding::dynamic_size, 12 >( bytes.data(),
+                                                                 4096u );
+
+  auto ok = histogram_check( bytes, 0u, pool ) &&
+            histogram_check( bytes, 3u, pool ) &&
+            histogram_check( view1, 5u, pool ) &&
+            histogram_check( view2, 3u, pool ) &&
+            histogram_check( view4, 1u, pool ) &&
+            histogram_check( view3, 7u, pool ) &&
+            histogram_check( view12, 1u, pool );
+  std::printf( "Histogram check: %s.\n", ok ? "OK" : "FAILED" );
+
+  // table construction with naive and banked counting
+  bytes.rewind();
+  auto start_time = std::chrono::high_resolution_clock::now();
+  coding::uint naive_p[ 256 ] = {};
+  while ( bytes )
+  {
+    ++naive_p[ bytes.read_symbol() ];
+  }
+  auto naive_time = std::chrono::high_resolution_clock::now() - start_time;
+  bytes.rewind();
+
+  coding::uint counts_p[ 256 ] = {};
+  start_time = std::chrono::high_resolution_clock::now();
+  coding::count_symbols( bytes, counts_p );
+  auto banked_time = std::chrono::high_resolution_clock::now() - start_time;
+
+  auto same = std::equal( naive_p, naive_p + 256, counts_p );
+  std::printf( "Counting %lu bytes (naive/banked): %li us / %li us (%s).\n\n",
+               size,
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 naive_time )
+                 .count(),
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 banked_time )
+                 .count(),
+               same ? "OK" : "FAILED" );
+}
+
+// bulk moves from given symbol on agree with single symbol ones
+template < std::size_t SL >
+bool symbol_span_check( std::size_t skip )
+{
+  const std::size_t count = 3001u;
+  using block_type = coding::data_block< coding::dynamic_size, SL >;
+  using symbol_type = typename block_type::symbol_type;
+
+  auto single = std::vector< symbol_type >( count );
+  auto data = block_type();
+  coding::uint seed = 88172645u;
+  for ( auto &s : single )
+  {
+    seed = seed * 1103515245u + 12345u;
+    s = static_cast< symbol_type >( ( seed >> 16u ) & ( ( 1u << SL ) - 1u ) );
+    data.write_symbol( s );
+  }
+
+  // writing in both directions, first symbols one by one
+  auto out = block_type();
+  for ( std::size_t i = 0u; i < skip; ++i )
+  {
+    out.write_symbol( single[ i ] );
+  }
+  out.write_symbols( single.data() + skip, count - skip );
+  auto rout = block_type();
+  rout.prepare( count );
+  rout.write_symbols_reverse( single.data() + skip, count - skip );
+  for ( std::size_t i = skip; i > 0u; --i )
+  {
+    rout.write_symbol_reverse( single[ i - 1u ] );
+  }
+  auto ok = out == data && rout == data && rout.is_beg();
+
+  // reading from skipped symbol to end of whole bytes and back
+  auto bulk = std::vector< symbol_type >( count );
+  auto n = count - skip - ( count * SL % 8u ) / SL;
+  data.rewind();
+  for ( std::size_t i = 0u; i < skip; ++i )
+  {
+    data.read_symbol();
+  }
+  data.read_symbols( bulk.data() + skip, n );
+  auto first = static_cast< std::ptrdiff_t >( skip );
+  auto last = static_cast< std::ptrdiff_t >( skip + n );
+  ok = ok && !data && data.symbols_left() == 0u &&
+       std::equal( single.begin() + first, single.begin() + last,
+                   bulk.begin() + first );
+
+  std::fill( bulk.begin(), bulk.end(), symbol_type{ 0u } );
+  data.read_symbols_reverse( bulk.data() + skip, n );
+  return ok &&
+         data.get_position() ==
+           std::make_pair( skip * SL / 8u, skip * SL % 8u ) &&
+         std::equal( single.begin() + first, single.begin() + last,
+                     bulk.begin() + first );
+}
+
+void symbol_span_test()
+{
+  std::printf( "SYMBOL SPAN TEST:\n\n" );
+
+  auto ok = symbol_span_check< 1 >( 0u ) && symbol_span_check< 1 >( 5u ) &&
+            symbol_span_check< 2 >( 3u ) && symbol_span_check< 4 >( 1u ) &&
+            symbol_span_check< 8 >( 2u ) && symbol_span_check< 3 >( 7u ) &&
+            symbol_span_check< 12 >( 1u );
+  std::printf( "Bulk symbol check: %s.\n", ok ? "OK" : "FAILED" );
+
+  // 1-bit symbols unpacked one by one and in bulk
+  const std::size_t size = 4u * 1024u * 1024u;
+  auto bits = coding::data_block< coding::dynamic_size, 1 >( size );
+  bits.prepare( size * 8u );
+  coding::uint seed = 2463534242u;
+  for ( std::size_t i = 0u; i < size; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    bits.data()[ i ] = static_cast< coding::byte >( seed >> 24u );
+  }
+
+  auto single = std::vector< coding::byte >( size * 8u );
+  auto bulk = std::vector< coding::byte >( size * 8u );
+  bits.rewind();
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for ( auto &s : single )
+  {
+    s = bits.read_symbol();
+  }
+  auto single_time = std::chrono::high_resolution_clock::now() - start_time;
+  bits.rewind();
+  start_time = std::chrono::high_resolution_clock::now();
+  bits.read_symbols( bulk.data(), bulk.size() );
+  auto bulk_time = std::chrono::high_resolution_clock::now() - start_time;
+
+  std::printf( "Unpacking %lu 1-bit symbols (single/bulk): %li us / %li us "
+               "(%s).\n\n",
+               single.size(),
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 single_time )
+                 .count(),
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 bulk_time )
+                 .count(),
+               single == bulk ? "OK" : "FAILED" );
+}
+
+// staged word I/O agrees with word by word access of bit buffer
+template < typename _Word >
+bool word_io_check( std::size_t count )
+{
+  auto words = std::vector< _Word >( count );
+  coding::uint seed = 362436069u;
+  for ( auto &w : words )
+  {
+    seed = seed * 1103515245u + 12345u;
+    w = static_cast< _Word >( seed ^ ( seed << 13u ) );
+  }
+
+  auto plain = coding::bit_buffer< coding::dynamic_size >();
+  auto staged = coding::bit_buffer< coding::dynamic_size >();
+  plain.write_value( coding::byte{ 7u } );
+  staged.write_value( coding::byte{ 7u } );
+  auto out = coding::word_writer< coding::dynamic_size, _Word >( staged );
+  for ( auto w : words )
+  {
+    plain.write_value( w );
+    out.write_value( w );
+  }
+  out.flush();
+  staged.write_value( coding::byte{ 9u } );
+  plain.write_value( coding::byte{ 9u } );
+  auto ok = staged.size() == plain.size() &&
+            std::memcmp( staged.data(), plain.data(), plain.size() ) == 0;
+
+  staged.rewind();
+  staged.advance( 1u );
+  auto in = coding::word_reader< coding::dynamic_size, _Word >( staged );
+  for ( auto w : words )
+  {
+    ok = ok && in.read_value() == w;
+  }
+  in.release();
+  ok = ok && staged.template read_value< coding::byte >() == 9u;
+
+  staged.reverse( 1u );
+  auto rin =
+    coding::word_reader_reverse< coding::dynamic_size, _Word >( staged );
+  for ( auto i = count; i > 0u; --i )
+  {
+    ok = ok && !rin.is_beg() && rin.read_value_reverse() == words[ i - 1u ];
+  }
+  rin.release();
+  return ok && rin.is_beg() && staged.curr() == staged.data() + 1u;
+}
+
+void word_io_test()
+{
+  std::printf( "WORD I/O TEST:\n\n" );
+
+  auto ok = word_io_check< coding::word >( 0u ) &&
+            word_io_check< coding::word >( 3u ) &&
+            word_io_check< coding::word >( 5001u ) &&
+            word_io_check< coding::uint >( 1u ) &&
+            word_io_check< coding::uint >( 5001u );
+
+  // fixed size buffer is checked once per batch of words
+  auto full = false;
+  auto small = coding::bit_buffer< 64 >();
+  auto out = coding::word_writer< 64, coding::word >( small );
+  try
+  {
+    for ( coding::word w = 0u; w < 40u; ++w )
+    {
+      out.write_value( w );
+    }
+  }
+  catch ( std::length_error const & )
+  {
+    full = small.size() == 64u;
+  }
+  std::printf( "Staged word check: %s.\n", ok && full ? "OK" : "FAILED" );
+
+  // 16-bit words written one by one and staged
+  const std::size_t count = 8u * 1024u * 1024u;
+  auto plain = coding::bit_buffer< coding::dynamic_size >( count * 2u );
+  auto staged = coding::bit_buffer< coding::dynamic_size >( count * 2u );
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    plain.write_word( static_cast< coding::word >( i ) );
+  }
+  auto plain_time = std::chrono::high_resolution_clock::now() - start_time;
+  start_time = std::chrono::high_resolution_clock::now();
+  auto writer = coding::word_writer< coding::dynamic_size, coding::word >(
+    staged );
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    writer.write_value( static_cast< coding::word >( i ) );
+  }
+  writer.flush();
+  auto staged_time = std::chrono::high_resolution_clock::now() - start_time;
+
+  auto same = staged.size() == plain.size() &&
+              std::memcmp( staged.data(), plain.data(), plain.size() ) == 0;
+  std::printf( "Writing %lu words (plain/staged): %li us / %li us (%s).\n\n",
+               count,
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 plain_time )
+                 .count(),
+               std::chrono::duration_cast< std::chrono::microseconds >(
+                 staged_time )
+                 .count(),
+               same ? "OK" : "FAILED" );
+}
+
 void compr_stats_basic_test()
 {
   auto cs = coding::compr_stats< 8 >();
@@ -230,8 +651,13 @@ int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
   bit_buffer_test();
   data_block_manual_test();
   data_block_file_test();
+  mapped_file_test();
   freq_table_test();
   num_freq_table_test();
+  freq_normalize_test();
+  histogram_test();
+  symbol_span_test();
+  word_io_test();
   compr_stats_basic_test();
 
   return 0;
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "data_block.h"
+#include "model_file.h"
+#include "num_freq_table.h"
+#include "num_freq_table_alias.h"
+#include "rans_batch.h"
+#include "rans_stream.h"
+
+constexpr std::size_t NUM = 12;
+constexpr std::size_t MESSAGE_COUNT = 1001;
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+using block_t = coding::data_block< coding::dynamic_size, 8 >;
+
+// records of similar text, every 7th is shorter and every 13th empty, so
+//  that lanes of group end at different symbols
+std::vector< block_t > record_blocks( std::size_t size )
+{
+  constexpr char const letters[] = "eeeetttaaoinshrdlucmfwypvbgkqjxz";
+  auto result = std::vector< block_t >( MESSAGE_COUNT );
+  coding::uint seed = 4711u;
+  for ( std::size_t i = 0u; i < MESSAGE_COUNT; ++i )
+  {
+    auto n = i % 13u == 0u ? 0u : ( i % 7u == 0u ? size / 3u : size );
+    for ( std::size_t j = 0u; j < n; ++j )
+    {
+      seed = seed * 1103515245u + 12345u;
+      auto r = ( seed >> 16u ) & 63u;
+      auto c = r < 32u ? letters[ r ] : ( r < 52u ? ' ' : '0' + ( r & 7u ) );
+      result[ i ].write_symbol( static_cast< coding::byte >( c ) );
+    }
+    result[ i ].rewind();
+  }
+  return result;
+}
+
+bool same_messages( std::vector< block_t > const &messages,
+                    std::vector< block_t > const &decoded )
+{
+  for ( std::size_t i = 0u; i < messages.size(); ++i )
+  {
+    if ( !( messages[ i ] == decoded[ i ] ) )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template < template < std::size_t, std::size_t > class _FreqTable,
+           std::size_t _Lanes >
+void batch_test( char const *name, std::size_t size )
+{
+  std::printf( "=== BATCH TEST (%s, %lu lanes, %lu x %lu bytes) ===\n\n",
+               name, _Lanes, MESSAGE_COUNT, size );
+
+  auto messages = record_blocks( size );
+  auto spans = std::vector< coding::rans::message_span >( MESSAGE_COUNT );
+
+  // shared model trained on messages themselves
+  auto trainer = coding::model_trainer< 8 >();
+  for ( auto &m : messages )
+  {
+    trainer.add( m );
+  }
+  auto model = trainer.template build< NUM, _FreqTable >();
+
+  auto bits = buffer_t();
+  auto decoded = std::vector< block_t >( MESSAGE_COUNT );
+  auto stats = coding::rans::encode_batch< NUM, _FreqTable, _Lanes >(
+    model, messages.data(), messages.size(), bits, spans.data() );
+  stats.set_decoding_time(
+    coding::rans::decode_batch< NUM, _FreqTable, _Lanes >(
+      model, bits, spans.data(), spans.size(), decoded.data() ) );
+  auto ok = same_messages( messages, decoded );
+
+  // every span is decodable on its own
+  auto single = block_t();
+  coding::rans::decode_batch< NUM, _FreqTable, _Lanes >(
+    model, bits, spans.data() + 5u, 1u, &single );
+  ok = ok && single == messages[ 5u ];
+
+  // model of every message in its span
+  auto own_bits = buffer_t();
+  auto own_decoded = std::vector< block_t >( MESSAGE_COUNT );
+  auto own_stats = coding::rans::encode_batch< NUM, _FreqTable, _Lanes >(
+    messages.data(), messages.size(), own_bits, spans.data() );
+  own_stats.set_decoding_time(
+    coding::rans::decode_batch< NUM, _FreqTable, _Lanes >(
+      own_bits, spans.data(), spans.size(), own_decoded.data() ) );
+  ok = ok && same_messages( messages, own_decoded );
+
+  // same messages coded one by one in forward layout
+  std::size_t call_bits = 0u;
+  auto call_time = std::chrono::nanoseconds( 0 );
+  for ( auto &m : messages )
+  {
+    auto message_bits = buffer_t();
+    m.rewind();
+    auto call_stats =
+      coding::rans::encode_forward< NUM, _FreqTable >( m, message_bits );
+    call_bits += call_stats.encoded_length();
+    call_time += call_stats.encoding_time();
+  }
+
+  std::printf( "Data consistency check after decoding: %s.\n",
+               ok ? "OK" : "FAILED" );
+  std::printf( "Encoded length (shared/own/calls): %lu / %lu / %lu bits.\n",
+               stats.encoded_length(), own_stats.encoded_length(),
+               call_bits );
+  std::printf( "Encoding time (shared/own/calls): %.3f / %.3f / %.3f ms.\n",
+               static_cast< double >( stats.encoding_time().count() ) * 1e-6,
+               static_cast< double >( own_stats.encoding_time().count() ) *
+                 1e-6,
+               static_cast< double >( call_time.count() ) * 1e-6 );
+  std::printf( "Decoding time (shared/own): %.3f / %.3f ms.\n\n\n",
+               static_cast< double >( stats.decoding_time().count() ) * 1e-6,
+               static_cast< double >( own_stats.decoding_time().count() ) *
+                 1e-6 );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  std::printf( "BATCH TESTS:\n\n" );
+
+  batch_test< coding::num_freq_table, 1 >( "num_freq_table", 256u );
+  batch_test< coding::num_freq_table, 4 >( "num_freq_table", 64u );
+  batch_test< coding::num_freq_table, 4 >( "num_freq_table", 256u );
+  batch_test< coding::num_freq_table, 8 >( "num_freq_table", 2000u );
+  batch_test< coding::num_freq_table_alias, 4 >( "alias", 256u );
+
+  return 0;
+}
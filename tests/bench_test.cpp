@@ -0,0 +1,554 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "freq_table.h"
+#include "model_file.h"
+#include "num_freq_table.h"
+#include "num_freq_table_adapt.h"
+#include "num_freq_table_alias.h"
+#include "num_freq_table_lookup.h"
+#include "rans.h"
+#include "rans_adaptive.h"
+#include "rans_batch.h"
+#include "rans_stream.h"
+
+// microbenchmark of table types x symbol length x numeral base over
+//  synthetic and file corpora; every case is repeated after warm-up and
+//  reported as median and p95 ( slowest 5% ) of its runs; corpora are
+//  also split into records of 64, 256 and 1024 bytes coded by batch API
+//
+// usage: bench [--runs R] [--warmup W] [--size BYTES] [--csv PATH]
+//              [--json PATH] [FILE...]
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+constexpr std::size_t RATE = 5;
+
+struct bench_options
+{
+  std::size_t runs = 15u;
+  std::size_t warmup = 3u;
+  std::size_t size = 64u * 1024u;
+  char const *csv_path = nullptr;
+  char const *json_path = nullptr;
+};
+
+struct corpus
+{
+  std::string name;
+  block_t< 8 > data;
+};
+
+// run times of single case
+struct bench_result
+{
+  std::string table;
+  std::string corpus;
+  std::string op;
+  std::size_t symbol_length;
+  std::size_t num_base;
+  std::size_t symbol_count;
+  std::size_t byte_count;
+  std::size_t record_count;  // messages ( or blocks ) coded by run
+  double median_ns;
+  double p95_ns;
+  double median_ticks;
+
+  double median_mbps() const noexcept
+  {
+    return static_cast< double >( byte_count ) * 1e3 / median_ns;
+  }
+
+  double p95_mbps() const noexcept
+  {
+    return static_cast< double >( byte_count ) * 1e3 / p95_ns;
+  }
+
+  double records_per_sec() const noexcept
+  {
+    return static_cast< double >( record_count ) * 1e9 / median_ns;
+  }
+
+  double cycles_per_symbol() const noexcept
+  {
+    return median_ticks / static_cast< double >( symbol_count );
+  }
+};
+
+// time stamp counter ( reference cycles ), 0 where not available
+coding::ulong ticks() noexcept
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+  return static_cast< coding::ulong >( __rdtsc() );
+#else
+  return 0u;
+#endif
+}
+
+double median( std::vector< double > values )
+{
+  std::sort( values.begin(), values.end() );
+  auto n = values.size();
+  return ( n & 1u ) != 0u ? values[ n >> 1u ]
+                          : 0.5 * ( values[ ( n >> 1u ) - 1u ] +
+                                    values[ n >> 1u ] );
+}
+
+double percentile_95( std::vector< double > values )
+{
+  std::sort( values.begin(), values.end() );
+  auto rank = ( values.size() * 95u + 99u ) / 100u;
+  return values[ rank > 0u ? rank - 1u : 0u ];
+}
+
+class bench_suite
+{
+public:
+  explicit bench_suite( bench_options const &options ) : m_options( options )
+  {
+  }
+
+  // runs prepare ( untimed ) and body ( timed ) for every repetition
+  template < typename _Prepare, typename _Body >
+  void run( bench_result result, _Prepare prepare, _Body body )
+  {
+    auto times = std::vector< double >{};
+    auto cycles = std::vector< double >{};
+    for ( std::size_t i = 0u; i < m_options.warmup + m_options.runs; ++i )
+    {
+      prepare();
+      auto start_ticks = ticks();
+      auto start_time = std::chrono::steady_clock::now();
+      body();
+      auto time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now() - start_time );
+      auto elapsed_ticks = ticks() - start_ticks;
+      if ( i >= m_options.warmup )
+      {
+        times.push_back( static_cast< double >( time.count() ) );
+        cycles.push_back( static_cast< double >( elapsed_ticks ) );
+      }
+    }
+
+    result.median_ns = std::max( median( times ), 1.0 );
+    result.p95_ns = std::max( percentile_95( times ), 1.0 );
+    result.median_ticks = median( cycles );
+    display( result );
+    m_results.push_back( std::move( result ) );
+  }
+
+  void display_header() const
+  {
+    std::printf( "%-22s %-18s %2s %2s %-6s %10s %10s %10s %10s %10s\n",
+                 "table", "corpus", "SL", "N", "op", "median MB/s",
+                 "p95 MB/s", "median us", "cyc/sym", "krec/s" );
+  }
+
+  void write_csv( char const *path ) const
+  {
+    auto *file_p = std::fopen( path, "w" );
+    if ( file_p == nullptr )
+    {
+      std::fprintf( stderr, "Cannot open %s for writing.\n", path );
+      return;
+    }
+    std::fprintf( file_p,
+                  "table,corpus,sl,num_base,op,symbols,bytes,records,"
+                  "median_ns,p95_ns,median_mbps,p95_mbps,cycles_per_symbol,"
+                  "records_per_sec\n" );
+    for ( auto const &r : m_results )
+    {
+      std::fprintf(
+        file_p,
+        "%s,%s,%lu,%lu,%s,%lu,%lu,%lu,%.0f,%.0f,%.3f,%.3f,%.3f,%.0f\n",
+        r.table.c_str(), r.corpus.c_str(), r.symbol_length, r.num_base,
+        r.op.c_str(), r.symbol_count, r.byte_count, r.record_count,
+        r.median_ns, r.p95_ns, r.median_mbps(), r.p95_mbps(),
+        r.cycles_per_symbol(), r.records_per_sec() );
+    }
+    std::fclose( file_p );
+  }
+
+  void write_json( char const *path ) const
+  {
+    auto *file_p = std::fopen( path, "w" );
+    if ( file_p == nullptr )
+    {
+      std::fprintf( stderr, "Cannot open %s for writing.\n", path );
+      return;
+    }
+    std::fprintf( file_p, "{\n  \"runs\": %lu,\n  \"warmup\": %lu,\n"
+                          "  \"results\": [\n",
+                  m_options.runs, m_options.warmup );
+    for ( std::size_t i = 0u; i < m_results.size(); ++i )
+    {
+      auto const &r = m_results[ i ];
+      std::fprintf(
+        file_p,
+        "    { \"table\": \"%s\", \"corpus\": \"%s\", \"sl\": %lu, "
+        "\"num_base\": %lu, \"op\": \"%s\", \"symbols\": %lu, "
+        "\"bytes\": %lu, \"records\": %lu, \"median_ns\": %.0f, "
+        "\"p95_ns\": %.0f, \"median_mbps\": %.3f, \"p95_mbps\": %.3f, "
+        "\"cycles_per_symbol\": %.3f, \"records_per_sec\": %.0f }%s\n",
+        r.table.c_str(), r.corpus.c_str(), r.symbol_length, r.num_base,
+        r.op.c_str(), r.symbol_count, r.byte_count, r.record_count,
+        r.median_ns, r.p95_ns, r.median_mbps(), r.p95_mbps(),
+        r.cycles_per_symbol(), r.records_per_sec(),
+        i + 1u < m_results.size() ? "," : "" );
+    }
+    std::fprintf( file_p, "  ]\n}\n" );
+    std::fclose( file_p );
+  }
+
+private:
+  static void display( bench_result const &r )
+  {
+    std::printf(
+      "%-22s %-18s %2lu %2lu %-6s %10.2f %10.2f %10.1f %10.2f %10.1f\n",
+      r.table.c_str(), r.corpus.c_str(), r.symbol_length, r.num_base,
+      r.op.c_str(), r.median_mbps(), r.p95_mbps(), r.median_ns / 1e3,
+      r.cycles_per_symbol(), r.records_per_sec() / 1e3 );
+  }
+
+private:
+  bench_options m_options;
+  std::vector< bench_result > m_results;
+};
+
+template < std::size_t SL >
+bench_result make_result( char const *table, corpus const &c, char const *op,
+                          std::size_t num_base, block_t< SL > const &data )
+{
+  auto result = bench_result{};
+  result.table = table;
+  result.corpus = c.name;
+  result.op = op;
+  result.symbol_length = SL;
+  result.num_base = num_base;
+  result.symbol_count = data.symbol_count();
+  result.byte_count = data.size();
+  result.record_count = 1u;
+  return result;
+}
+
+// freq_table has no numeral coder, only its construction is measured
+template < std::size_t SL >
+void bench_freq_table( bench_suite &suite, corpus &c )
+{
+  auto data = block_t< SL >( c.data.data(), c.data.size() );
+  double sink = 0.0;
+  suite.run( make_result( "freq_table", c, "build", 0u, data ),
+             [ & ] { data.rewind(); },
+             [ & ] {
+               auto ft = coding::freq_table< SL >( data );
+               sink += static_cast< double >( ft.symbol_count() );
+             } );
+  if ( sink < 0.0 )
+  {
+    std::printf( "Impossible sum!\n" );
+  }
+}
+
+// static tables coded in forward layout
+template < std::size_t SL, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+void bench_static( bench_suite &suite, corpus &c, char const *table )
+{
+  auto data = block_t< SL >( c.data.data(), c.data.size() );
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+
+  coding::uint sink = 0u;
+  suite.run( make_result( table, c, "build", NUM, data ),
+             [ & ] { data.rewind(); },
+             [ & ] {
+               auto ft = _FreqTable< SL, NUM >( data );
+               sink += ft.cdf( ft.size() - 1u );
+             } );
+  suite.run( make_result( table, c, "encode", NUM, data ),
+             [ & ] {
+               data.rewind();
+               bits.reset();
+             },
+             [ & ] {
+               coding::rans::encode_forward< NUM, _FreqTable >( data, bits );
+             } );
+  suite.run( make_result( table, c, "decode", NUM, data ),
+             [ & ] {
+               bits.rewind();
+               dout.reset();
+             },
+             [ & ] {
+               coding::rans::decode_forward< NUM, _FreqTable >( bits, dout );
+             } );
+
+  if ( dout != data || sink == 0u )
+  {
+    std::printf( "Benchmark of %s produced invalid output!\n", table );
+  }
+}
+
+template < std::size_t SL, std::size_t NUM >
+void bench_adaptive( bench_suite &suite, corpus &c )
+{
+  auto data = block_t< SL >( c.data.data(), c.data.size() );
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+
+  coding::uint sink = 0u;
+  suite.run( make_result( "num_freq_table_adapt", c, "build", NUM, data ),
+             [ & ] { data.rewind(); },
+             [ & ] {
+               auto ft = coding::num_freq_table_adapt< SL, NUM, RATE >( data );
+               sink += ft.cdf( ft.size() - 1u );
+             } );
+  suite.run( make_result( "num_freq_table_adapt", c, "encode", NUM, data ),
+             [ & ] {
+               data.rewind();
+               bits.reset();
+             },
+             [ & ] {
+               coding::rans::encode_adaptive< NUM, RATE >( data, bits );
+             } );
+  suite.run( make_result( "num_freq_table_adapt", c, "decode", NUM, data ),
+             [ & ] {
+               bits.rewind();
+               dout.reset();
+             },
+             [ & ] {
+               coding::rans::decode_adaptive< NUM, RATE >( bits, dout );
+             } );
+
+  if ( dout != data || sink == 0u )
+  {
+    std::printf( "Benchmark of adaptive table produced invalid output!\n" );
+  }
+}
+
+template < std::size_t SL, std::size_t NUM >
+void bench_num_base( bench_suite &suite, corpus &c )
+{
+  bench_static< SL, NUM, coding::num_freq_table >( suite, c,
+                                                   "num_freq_table" );
+  bench_static< SL, NUM, coding::num_freq_table_alias >(
+    suite, c, "num_freq_table_alias" );
+  bench_adaptive< SL, NUM >( suite, c );
+}
+
+template < std::size_t SL >
+void bench_symbol_length( bench_suite &suite, corpus &c )
+{
+  bench_freq_table< SL >( suite, c );
+  bench_num_base< SL, 10 >( suite, c );
+  bench_num_base< SL, 12 >( suite, c );
+  bench_num_base< SL, 15 >( suite, c );
+}
+
+// corpus split into records of size bytes, coded by batch API with shared
+//  model trained on corpus ( decoded with its slot lookup, built once ) and
+//  one by one with same model
+template < std::size_t NUM >
+void bench_batch( bench_suite &suite, corpus &c, std::size_t size )
+{
+  using table_type = coding::num_freq_table< 8, NUM >;
+
+  auto data = block_t< 8 >( c.data.data(), c.data.size() );
+  auto count = data.size() / size;
+  if ( count == 0u )
+  {
+    return;
+  }
+
+  auto messages = std::vector< block_t< 8 > >{};
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    messages.emplace_back( c.data.data() + i * size, size );
+  }
+  auto decoded = std::vector< block_t< 8 > >( count );
+  auto spans = std::vector< coding::rans::message_span >( count );
+  auto bits = buffer_t();
+
+  auto trainer = coding::model_trainer< 8 >();
+  trainer.add( data );
+  auto model = trainer.build< NUM, coding::num_freq_table >();
+  auto lookup = coding::num_freq_table_lookup< 8, NUM >( model );
+
+  auto name = "batch/" + std::to_string( size ) + "B";
+  auto result = make_result( name.c_str(), c, "encode", NUM, data );
+  result.symbol_count = count * size;
+  result.byte_count = count * size;
+  result.record_count = count;
+  suite.run( result, [ & ] { bits.reset(); },
+             [ & ] {
+               coding::rans::encode_batch< NUM, coding::num_freq_table >(
+                 model, messages.data(), count, bits, spans.data() );
+             } );
+  result.op = "decode";
+  suite.run( result,
+             [ & ] {
+               for ( auto &d : decoded )
+               {
+                 d.reset();
+               }
+             },
+             [ & ] {
+               coding::rans::decode_batch< NUM,
+                                           coding::num_freq_table_lookup >(
+                 lookup, bits, spans.data(), count, decoded.data() );
+             } );
+
+  // one rans::encode call per record
+  result.table = "calls/" + std::to_string( size ) + "B";
+  result.op = "encode";
+  auto call_bits = buffer_t();
+  suite.run( result, [ & ] { call_bits.reset(); },
+             [ & ] {
+               for ( auto &m : messages )
+               {
+                 m.rewind();
+                 coding::rans::encode< NUM, coding::num_freq_table >(
+                   static_cast< table_type const & >( model ), m,
+                   call_bits );
+               }
+             } );
+
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    if ( !( decoded[ i ] == messages[ i ] ) )
+    {
+      std::printf( "Benchmark of %s produced invalid output!\n",
+                   name.c_str() );
+      return;
+    }
+  }
+}
+
+// bytes of uniform, geometric and random walk distributions
+std::vector< corpus > synthetic_corpora( std::size_t size )
+{
+  auto result = std::vector< corpus >{};
+  char const *names[] = { "uniform", "geometric", "random-walk" };
+  for ( std::size_t k = 0u; k < 3u; ++k )
+  {
+    auto data = block_t< 8 >( size );
+    coding::uint seed = 2463534242u;
+    int value = 128;
+    for ( std::size_t i = 0u; i < size; ++i )
+    {
+      seed ^= seed << 13u;
+      seed ^= seed >> 17u;
+      seed ^= seed << 5u;
+      coding::byte symbol = 0u;
+      if ( k == 0u )
+      {
+        symbol = static_cast< coding::byte >( seed >> 24u );
+      }
+      else if ( k == 1u )
+      {
+        // leading zeros of random value: P(s) = 2^-(s+1)
+        auto bits = seed | 1u;
+        while ( ( bits & 0x80000000u ) == 0u )
+        {
+          bits <<= 1u;
+          ++symbol;
+        }
+      }
+      else
+      {
+        value += static_cast< int >( seed % 7u ) - 3;
+        value = value < 0 ? 0 : ( value > 255 ? 255 : value );
+        symbol = static_cast< coding::byte >( value );
+      }
+      data.write_symbol( symbol );
+    }
+    result.push_back( corpus{ names[ k ], std::move( data ) } );
+  }
+  return result;
+}
+
+int main( int argc, char const *argv[] )
+{
+  auto options = bench_options{};
+  auto files = std::vector< char const * >{};
+  for ( int i = 1; i < argc; ++i )
+  {
+    auto has_value = i + 1 < argc;
+    if ( std::strcmp( argv[ i ], "--runs" ) == 0 && has_value )
+    {
+      options.runs = std::strtoul( argv[ ++i ], nullptr, 10 );
+    }
+    else if ( std::strcmp( argv[ i ], "--warmup" ) == 0 && has_value )
+    {
+      options.warmup = std::strtoul( argv[ ++i ], nullptr, 10 );
+    }
+    else if ( std::strcmp( argv[ i ], "--size" ) == 0 && has_value )
+    {
+      options.size = std::strtoul( argv[ ++i ], nullptr, 10 );
+    }
+    else if ( std::strcmp( argv[ i ], "--csv" ) == 0 && has_value )
+    {
+      options.csv_path = argv[ ++i ];
+    }
+    else if ( std::strcmp( argv[ i ], "--json" ) == 0 && has_value )
+    {
+      options.json_path = argv[ ++i ];
+    }
+    else
+    {
+      files.push_back( argv[ i ] );
+    }
+  }
+  options.runs = std::max( options.runs, std::size_t{ 1u } );
+  if ( files.empty() )
+  {
+    files = { "LICENSE", ".clang-tidy" };
+  }
+
+  auto corpora = synthetic_corpora( options.size );
+  for ( auto const *path : files )
+  {
+    corpora.push_back( corpus{ path, block_t< 8 >( path ) } );
+  }
+
+  std::printf( "BENCHMARK (%lu runs after %lu warm-up runs):\n\n",
+               options.runs, options.warmup );
+
+  auto suite = bench_suite( options );
+  suite.display_header();
+  for ( auto &c : corpora )
+  {
+    bench_symbol_length< 1 >( suite, c );
+    bench_symbol_length< 2 >( suite, c );
+    bench_symbol_length< 4 >( suite, c );
+    bench_symbol_length< 8 >( suite, c );
+  }
+  for ( auto &c : corpora )
+  {
+    bench_batch< 12 >( suite, c, 64u );
+    bench_batch< 12 >( suite, c, 256u );
+    bench_batch< 12 >( suite, c, 1024u );
+  }
+
+  if ( options.csv_path != nullptr )
+  {
+    suite.write_csv( options.csv_path );
+  }
+  if ( options.json_path != nullptr )
+  {
+    suite.write_json( options.json_path );
+  }
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include "fib_coding.h"
+
+// bit sequence written and read back by Fibonacci codes
+struct bit_list
+{
+  void write_bit( bool bit ) { bits.push_back( bit ); }
+
+  bool read_bit() { return pos < bits.size() && bits[ pos++ ]; }
+
+  std::vector< bool > bits;
+  std::size_t pos = 0u;
+};
+
+// longest codes round trip, code without terminator is rejected
+void code_test()
+{
+  auto list = bit_list{};
+  auto const largest = coding::fib::number( coding::fib::max_length - 1u );
+  coding::fib::write_code( list, 1u );
+  coding::fib::write_code( list, largest );
+  coding::fib::write_code( list, largest + 1u );
+  auto ok = coding::fib::read_code( list ) == 1u &&
+            coding::fib::read_code( list ) == largest &&
+            coding::fib::read_code( list ) == largest + 1u &&
+            list.pos == list.bits.size();
+
+  // alternating bits never form terminator
+  auto malformed = bit_list{};
+  for ( std::size_t i = 0u; i <= coding::fib::max_length; ++i )
+  {
+    malformed.write_bit( ( i & 1u ) == 0u );
+  }
+  try
+  {
+    coding::fib::read_code( malformed );
+    ok = false;
+  }
+  catch ( std::invalid_argument const & )
+  {
+  }
+
+  std::printf( " ==> Code round trip and missing terminator: %s\n\n",
+               ok ? "OK" : "FAILED" );
+}
+
+void fib_row( coding::ulong value )
+{
+  auto bits = coding::fib::encode( value );
+  auto decoded = coding::fib::decode( bits );
+
+  std::printf( "%15lu | ", value );
+  for ( std::size_t i = 0u; i < coding::fib::max_length; ++i )
+  {
+    std::printf( "%c", bits[ i ] ? '1' : '0' );
+  }
+  std::printf( " | %15lu | %s\n", decoded,
+               ( decoded == value ) ? "    OK  " : " FAILED " );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  std::printf( "Base value:     | %-92s | %-15s | Result:\n", "Encoded:",
+               "Decoded:" );
+  std::printf( "=============== | %-92s | =============== | ==========\n",
+               "===========" );
+
+  std::printf( " ==> From lecture:\n" );
+  fib_row( 73u );
+
+  std::printf( " ==> Initial integers (0-32):\n" );
+  for ( coding::ulong i = 0u; i <= 32u; ++i )
+  {
+    fib_row( i );
+  }
+
+  std::printf( " ==> Fibonacci numbers (F_60 - F_70):\n" );
+  for ( std::size_t i = 60u; i <= 70u; ++i )
+  {
+    fib_row( coding::fib::number( i ) );
+  }
+
+  std::printf( " ==> Powers of ten (10^2 - 10^14):\n" );
+  coding::ulong power = 10u;
+  for ( std::size_t i = 2u; i <= 14u; ++i )
+  {
+    power *= 10u;
+    fib_row( power );
+  }
+
+  std::printf( "\n" );
+  code_test();
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#include "freq_table.h"
+#include "header_codec.h"
+#include "num_freq_table.h"
+#include "num_freq_table_alias.h"
+#include "num_freq_table_lookup.h"
+
+constexpr std::size_t NUM = 12;
+constexpr std::size_t PARSE_COUNT = 1000;
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+constexpr coding::header_format formats[] = {
+  coding::header_format::raw, coding::header_format::varint,
+  coding::header_format::fibonacci
+};
+
+constexpr char const *format_names[] = { "raw", "varint", "fibonacci" };
+
+// header size, parse time and round trip in both directions
+template < typename _Table >
+void header_row( char const *name, _Table const &ft,
+                 coding::header_format format, char const *format_name )
+{
+  auto bits = buffer_t();
+  ft.write_header( bits, format );
+  auto size = bits.size();
+
+  bits.rewind();
+  auto ok = ft.header_length( format ) == size << 3u;
+  ok = ok && _Table( bits ) == ft && !bits;
+  bits.fast_forward();
+  ok = ok && _Table::read_header_reverse( bits ) == ft &&
+       bits.curr() == bits.data();
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for ( std::size_t i = 0u; i < PARSE_COUNT; ++i )
+  {
+    bits.rewind();
+    auto rft = _Table( bits );
+    ok = ok && rft == ft;
+  }
+  auto parse_time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+    std::chrono::high_resolution_clock::now() - start_time );
+
+  std::printf( "%-10s | %-9s | %7lu | %9.1f | %s\n", name, format_name, size,
+               static_cast< double >( parse_time.count() ) /
+                 static_cast< double >( PARSE_COUNT ),
+               ok ? "   OK " : "FAILED" );
+}
+
+template < std::size_t SL >
+void header_test( char const *filepath )
+{
+  std::printf( "=== FREQUENCY TABLE HEADER TEST (SL = %lu, %s) ===\n\n", SL,
+               filepath );
+  std::printf( "Table:     | Format:   | Bytes:  | Parse ns: | Result:\n" );
+  std::printf( "========== | ========= | ======= | ========= | =======\n" );
+
+  auto data = block_t< SL >( filepath );
+  auto num = coding::num_freq_table< SL, NUM >( data );
+  auto alias = coding::num_freq_table_alias< SL, NUM >( data );
+  auto lookup = coding::num_freq_table_lookup< SL, NUM >( data );
+
+  for ( std::size_t i = 0u; i < 3u; ++i )
+  {
+    header_row( "num", num, formats[ i ], format_names[ i ] );
+    header_row( "alias", alias, formats[ i ], format_names[ i ] );
+    header_row( "lookup", lookup, formats[ i ], format_names[ i ] );
+  }
+
+  std::printf( "\n\n" );
+}
+
+// tables with few symbols present have symbols listed by gaps
+void sparse_header_test()
+{
+  std::printf( "=== SPARSE FREQUENCY TABLE HEADER TEST (SL = 8) ===\n\n" );
+  std::printf( "Table:     | Format:   | Bytes:  | Parse ns: | Result:\n" );
+  std::printf( "========== | ========= | ======= | ========= | =======\n" );
+
+  auto data = block_t< 8 >( 4096u );
+  for ( std::size_t i = 0u; i < 4096u; ++i )
+  {
+    data.write_symbol( static_cast< coding::byte >( 'a' + ( i * i ) % 7u ) );
+  }
+  data.rewind();
+  auto ft = coding::freq_table< 8 >( data );
+  auto num = coding::num_freq_table< 8, NUM >( data );
+
+  for ( std::size_t i = 0u; i < 3u; ++i )
+  {
+    header_row( "freq", ft, formats[ i ], format_names[ i ] );
+    header_row( "num", num, formats[ i ], format_names[ i ] );
+  }
+
+  std::printf( "\n\n" );
+}
+
+// header of given payload bytes is rejected by table reading it
+bool malformed_header( coding::byte tag, coding::byte const *payload_p,
+                       std::size_t length )
+{
+  auto bits = buffer_t();
+  bits.write_value( tag );
+  bits.write( length, payload_p );
+  bits.write_value( static_cast< coding::byte >( length ) );
+  bits.rewind();
+  try
+  {
+    coding::num_freq_table< 8, NUM >{ bits };
+  }
+  catch ( std::invalid_argument const & )
+  {
+    return true;
+  }
+  return false;
+}
+
+void malformed_header_test()
+{
+  // one symbol listed by gap past 2^SL symbols
+  coding::byte const gap_p[] = { 0x01u, 0xacu, 0x02u };
+  auto ok = malformed_header( 0x11u, gap_p, sizeof( gap_p ) );
+
+  // symbols 0 and 1 in bitmap, frequency of 0 above 2^N
+  coding::byte bitmap_p[ 34 ] = { 0x03u };
+  bitmap_p[ 32 ] = 0x80u;
+  bitmap_p[ 33 ] = 0x20u;
+  ok = ok && malformed_header( 0x01u, bitmap_p, sizeof( bitmap_p ) );
+
+  // frequency of 0 equal to 2^N leaves nothing to symbol 1
+  bitmap_p[ 32 ] = 0xffu;
+  bitmap_p[ 33 ] = 0x1fu;
+  ok = ok && malformed_header( 0x01u, bitmap_p, sizeof( bitmap_p ) );
+
+  std::printf( "=== MALFORMED HEADER TEST: %s ===\n\n",
+               ok ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  header_test< 1 >( "LICENSE" );
+  header_test< 2 >( "LICENSE" );
+  header_test< 4 >( "LICENSE" );
+  header_test< 8 >( "LICENSE" );
+  header_test< 8 >( ".clang-tidy" );
+  sparse_header_test();
+  malformed_header_test();
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+#include <cstdio>
+
+#include "data_block.h"
+#include "num_freq_table.h"
+#include "num_freq_table_alias.h"
+#include "num_freq_table_lookup.h"
+#include "rans.h"
+#include "rans_simd.h"
+#include "rans_stream.h"
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+// symbols spanning byte boundaries are read back in both directions
+template < std::size_t SL >
+bool data_block_test()
+{
+  const std::size_t count = 1000u;
+  auto data = block_t< SL >();
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    data.write_symbol( static_cast< coding::sym_word< SL > >( i * 40503u ) );
+  }
+
+  auto ok = data.symbol_count() == count;
+  data.rewind();
+  for ( std::size_t i = 0u; i < count; ++i )
+  {
+    auto expected = ( i * 40503u ) & ( ( 1u << SL ) - 1u );
+    ok = ok && data.read_symbol() == expected;
+  }
+  for ( std::size_t i = count; i > 0u; --i )
+  {
+    auto expected = ( ( i - 1u ) * 40503u ) & ( ( 1u << SL ) - 1u );
+    ok = ok && data.read_symbol_reverse() == expected;
+  }
+
+  // reverse writing into prepared block
+  auto rout = block_t< SL >();
+  rout.prepare( count );
+  for ( std::size_t i = count; i > 0u; --i )
+  {
+    rout.write_symbol_reverse(
+      static_cast< coding::sym_word< SL > >( ( i - 1u ) * 40503u ) );
+  }
+  ok = ok && rout == data;
+
+  std::printf( "Data block (SL = %2lu): %lu bytes, %s.\n", SL, data.size(),
+               ok ? "OK" : "FAILED" );
+  return ok;
+}
+
+// quantized 12-bit samples of slowly changing sensor
+block_t< 12 > sensor_block( std::size_t size )
+{
+  auto data = block_t< 12 >();
+  coding::uint seed = 12345u;
+  int value = 2048;
+  for ( std::size_t i = 0u; i < size; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    value += static_cast< int >( ( seed >> 16u ) % 9u ) - 4;
+    value = value < 0 ? 0 : ( value > 4095 ? 4095 : value );
+    data.write_symbol( static_cast< coding::word >( value ) );
+  }
+  data.rewind();
+  return data;
+}
+
+// 16-bit tokens with roughly Zipfian ranks scattered over whole alphabet
+block_t< 16 > token_block( std::size_t size )
+{
+  auto data = block_t< 16 >();
+  coding::uint seed = 54321u;
+  for ( std::size_t i = 0u; i < size; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    auto rank = 4095u / ( ( ( seed >> 8u ) & 4095u ) + 1u );
+    data.write_symbol( static_cast< coding::word >( rank * 40503u + 1u ) );
+  }
+  data.rewind();
+  return data;
+}
+
+template < std::size_t SL, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+coding::ulong rans64_test( char const *name, block_t< SL > &data )
+{
+  using policy = coding::rans::rans64;
+
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  data.rewind();
+  auto stats = coding::rans::encode< NUM, _FreqTable, policy >( data, bits );
+  dout.prepare( data.symbol_count() );
+  stats.set_decoding_time(
+    coding::rans::decode< NUM, _FreqTable, policy >( bits, dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               data == dout ? "OK" : "FAILED" );
+  stats.display( name );
+  std::printf( "\n" );
+  return stats.encoded_length();
+}
+
+template < std::size_t SL, std::size_t NUM >
+coding::ulong rans_forward_test( char const *name, block_t< SL > &data )
+{
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  data.rewind();
+  auto stats =
+    coding::rans::encode_forward< NUM, coding::num_freq_table >( data, bits );
+  bits.rewind();
+  stats.set_decoding_time(
+    coding::rans::decode_forward< NUM, coding::num_freq_table >( bits,
+                                                                  dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+  stats.display( name );
+  std::printf( "\n" );
+  return stats.encoded_length();
+}
+
+// slot lookup and SIMD decode tables keep whole symbols
+template < std::size_t SL >
+void decode_table_test( block_t< SL > &data )
+{
+  namespace rans = coding::rans;
+
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  data.rewind();
+  rans::encode< 15, coding::num_freq_table_lookup >( data, bits );
+  dout.prepare( data.symbol_count() );
+  rans::decode< 15, coding::num_freq_table_lookup >( bits, dout );
+  auto lookup_ok = data == dout;
+
+  bits.reset();
+  data.rewind();
+  rans::encode_interleaved< 15, coding::num_freq_table, 8 >( data, bits );
+  auto simd_out = block_t< SL >();
+  rans::decode_simd< 15, coding::num_freq_table, 8 >( bits, simd_out );
+  auto simd_ok = data == simd_out;
+
+  std::printf( "Slot lookup decoding (SL = %lu): %s.\n", SL,
+               lookup_ok ? "OK" : "FAILED" );
+  std::printf( "SIMD decoding (SL = %lu): %s.\n\n", SL,
+               simd_ok ? "OK" : "FAILED" );
+}
+
+// same data coded as whole symbols and split into bytes
+template < std::size_t SL >
+void byte_split_test( char const *name, block_t< SL > &data,
+                      coding::ulong whole_length )
+{
+  auto bytes = block_t< 8 >( data.data(), data.size() );
+  auto split_length = rans_forward_test< 8, 12 >( "rANS (bytes)", bytes );
+
+  std::printf( "%s: %lu bits as %lu-bit symbols, %lu bits as bytes "
+               "( %.2f%% saved ).\n\n\n",
+               name, whole_length, SL, split_length,
+               100.0 - 100.0 * static_cast< double >( whole_length ) /
+                         static_cast< double >( split_length ) );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  std::printf( "LARGE ALPHABET TESTS:\n\n" );
+
+  data_block_test< 3 >();
+  data_block_test< 10 >();
+  data_block_test< 12 >();
+  data_block_test< 13 >();
+  data_block_test< 16 >();
+  std::printf( "\n\n" );
+
+  std::printf( "=== 12-BIT SENSOR SAMPLES ===\n\n" );
+  auto sensor = sensor_block( 1u << 16u );
+  auto sensor_length =
+    rans_forward_test< 12, 15 >( "rANS (12-bit, forward)", sensor );
+  rans64_test< 12, 16, coding::num_freq_table >( "rANS (12-bit, 64-bit state)",
+                                                 sensor );
+  rans64_test< 12, 16, coding::num_freq_table_alias >(
+    "rANS (12-bit, alias)", sensor );
+  decode_table_test( sensor );
+  byte_split_test( "12-bit sensor", sensor, sensor_length );
+
+  std::printf( "=== 16-BIT TOKENS ===\n\n" );
+  auto tokens = token_block( 1u << 16u );
+  auto tokens_length = rans64_test< 16, 20, coding::num_freq_table >(
+    "rANS (16-bit, 64-bit state)", tokens );
+  rans64_test< 16, 20, coding::num_freq_table_alias >( "rANS (16-bit, alias)",
+                                                       tokens );
+  byte_split_test( "16-bit tokens", tokens, tokens_length );
+
+  return 0;
+}
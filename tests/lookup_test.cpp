@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+
+#include "num_freq_table.h"
+#include "num_freq_table_alias.h"
+#include "num_freq_table_lookup.h"
+#include "rans.h"
+
+template < std::size_t SL, std::size_t N, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+double symbol_lookup_bench( char const *name, std::size_t rounds )
+{
+  auto data = coding::data_block< N, SL >( ".clang-tidy" );
+  auto ft = _FreqTable< SL, NUM >( data );
+  auto mask = static_cast< coding::ulong >( ft.num_mask() );
+
+  // walks all slots in pseudo-random order, as decoder does
+  coding::ulong x = 0x2545f491ul;
+  coding::ulong checksum = 0u;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for ( std::size_t i = 0u; i < rounds; ++i )
+  {
+    auto value = x & mask;
+    auto s = ft.symbol( static_cast< coding::word >( value ) );
+    auto [ f, cdf ] = ft.adjusted_f_and_cdf( s, value );
+    checksum += s + f + cdf;
+    x = x * 6364136223846793005ul + 1442695040888963407ul + checksum;
+  }
+  auto time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+    std::chrono::high_resolution_clock::now() - start_time );
+
+  auto ns_per_lookup =
+    static_cast< double >( time.count() ) / static_cast< double >( rounds );
+  std::printf( " %-24s SL=%lu: %8.3f ns/lookup   (checksum: %016lx)\n", name,
+               SL, ns_per_lookup, checksum );
+  return ns_per_lookup;
+}
+
+template < std::size_t SL, std::size_t N, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+void decode_bench( char const *name, std::size_t rounds )
+{
+  auto data = coding::data_block< N, SL >( ".clang-tidy" );
+  auto bits = coding::bit_buffer< 4 * 1024 >();
+  auto dout = coding::data_block< N, SL >();
+
+  auto total = std::chrono::nanoseconds{};
+  auto ok = true;
+  for ( std::size_t i = 0u; i < rounds; ++i )
+  {
+    data.rewind();
+    bits.reset();
+    dout.reset();
+    dout.prepare_full();
+    coding::rans::encode< NUM, _FreqTable >( data, bits );
+    total += coding::rans::decode< NUM, _FreqTable >( bits, dout );
+    ok = ok && ( data == dout );
+  }
+
+  std::printf( " %-24s SL=%lu: %10li ns/block   (consistency: %s)\n", name, SL,
+               total.count() / static_cast< long >( rounds ),
+               ok ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  const std::size_t N = 2 * 1024;
+  const std::size_t NUM = 12;
+  const std::size_t LOOKUPS = 1u << 22u;
+  const std::size_t BLOCKS = 64u;
+
+  std::printf( "DECODE LOOKUP TABLE TESTS:\n\n" );
+
+  std::printf( "Symbol lookup (symbol + f/cdf):\n" );
+  symbol_lookup_bench< 4, N, NUM, coding::num_freq_table >( "linear scan",
+                                                            LOOKUPS );
+  symbol_lookup_bench< 4, N, NUM, coding::num_freq_table_alias >( "alias",
+                                                                  LOOKUPS );
+  symbol_lookup_bench< 4, N, NUM, coding::num_freq_table_lookup >(
+    "slot lookup", LOOKUPS );
+  symbol_lookup_bench< 8, N, NUM, coding::num_freq_table >( "linear scan",
+                                                            LOOKUPS );
+  symbol_lookup_bench< 8, N, NUM, coding::num_freq_table_alias >( "alias",
+                                                                  LOOKUPS );
+  symbol_lookup_bench< 8, N, NUM, coding::num_freq_table_lookup >(
+    "slot lookup", LOOKUPS );
+
+  std::printf( "\nrANS decoding (%lu byte block):\n", N );
+  decode_bench< 4, N, NUM, coding::num_freq_table >( "linear scan", BLOCKS );
+  decode_bench< 4, N, NUM, coding::num_freq_table_alias >( "alias", BLOCKS );
+  decode_bench< 4, N, NUM, coding::num_freq_table_lookup >( "slot lookup",
+                                                            BLOCKS );
+  decode_bench< 8, N, NUM, coding::num_freq_table >( "linear scan", BLOCKS );
+  decode_bench< 8, N, NUM, coding::num_freq_table_alias >( "alias", BLOCKS );
+  decode_bench< 8, N, NUM, coding::num_freq_table_lookup >( "slot lookup",
+                                                            BLOCKS );
+
+  std::printf( "\n" );
+
+  return 0;
+}
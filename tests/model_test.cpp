@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+#include "data_block.h"
+#include "model_file.h"
+#include "num_freq_table.h"
+#include "num_freq_table_alias.h"
+#include "rans.h"
+
+constexpr std::size_t NUM = 12;
+constexpr std::size_t BLOCK_SIZE = 256;
+constexpr std::size_t TRAIN_COUNT = 256;
+constexpr std::size_t TEST_COUNT = 1024;
+constexpr std::size_t PAD_PERIOD = 4;
+constexpr std::size_t PAD_SIZE = 3;
+
+constexpr char const *MODEL_PATH = "model_test.rmdl";
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+using block_t = coding::data_block< coding::dynamic_size, 8 >;
+
+// short records of same kind ( e.g. log lines ): words of few letters and
+//  digits separated by spaces, some of them led by 0x00 padding bytes
+block_t record_block( coding::uint &seed, std::size_t pad = 0u )
+{
+  constexpr char const letters[] = "eeeetttaaoinshrdlucmfwypvbgkqjxz";
+  auto data = block_t();
+  for ( std::size_t i = 0u; i < pad; ++i )
+  {
+    data.write_symbol( 0u );
+  }
+  for ( std::size_t i = pad; i < BLOCK_SIZE; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    auto r = ( seed >> 16u ) & 63u;
+    auto c = r < 32u ? letters[ r ] : ( r < 52u ? ' ' : '0' + ( r & 7u ) );
+    data.write_symbol( static_cast< coding::byte >( c ) );
+  }
+  data.rewind();
+  return data;
+}
+
+template < template < std::size_t, std::size_t > class _FreqTable >
+void model_test( char const *name )
+{
+  std::printf( "=== TRAINED MODEL TEST (%s, %lu x %lu bytes) ===\n\n", name,
+               TEST_COUNT, BLOCK_SIZE );
+
+  // model trained on corpus and saved
+  coding::uint seed = 777u;
+  auto trainer = coding::model_trainer< 8 >();
+  for ( std::size_t i = 0u; i < TRAIN_COUNT; ++i )
+  {
+    auto data = record_block( seed, i % PAD_PERIOD == 0u ? PAD_SIZE : 0u );
+    trainer.add( data );
+  }
+  coding::save_model( MODEL_PATH, 7u,
+                      trainer.template build< NUM, _FreqTable >() );
+
+  // loaded once by coder of other blocks
+  auto models = coding::model_set< 8, NUM, _FreqTable >();
+  auto ok = models.load( MODEL_PATH ) == 7u && models.size() == 1u;
+
+  // padded blocks start with symbols of cdf 0, which model id coding must
+  //  keep as well
+  std::size_t model_bits = 0u;
+  std::size_t header_bits = 0u;
+  for ( std::size_t i = 0u; i < TEST_COUNT; ++i )
+  {
+    auto data = record_block( seed, i % PAD_PERIOD == 0u ? PAD_SIZE : 0u );
+    auto bits = buffer_t();
+    auto dout = block_t();
+    auto stats = coding::rans::encode< NUM, _FreqTable >( models, 7u, data,
+                                                          bits );
+    coding::rans::decode< NUM, _FreqTable >( models, bits, dout );
+    ok = ok && data == dout && dout.is_beg() && bits.is_beg();
+    model_bits += stats.encoded_length();
+
+    auto hbits = buffer_t();
+    data.rewind();
+    header_bits +=
+      coding::rans::encode< NUM, _FreqTable >( data, hbits ).encoded_length();
+  }
+
+  // unknown model and damaged file are rejected
+  auto bits = buffer_t();
+  bits.write_value( static_cast< coding::byte >( 9u ) );
+  auto dout = block_t();
+  try
+  {
+    coding::rans::decode< NUM, _FreqTable >( models, bits, dout );
+    ok = false;
+  }
+  catch ( std::out_of_range const & )
+  {
+  }
+  bits.rewind();
+  try
+  {
+    coding::read_model< 8, NUM, _FreqTable >( bits );
+    ok = false;
+  }
+  catch ( std::runtime_error const & )
+  {
+  }
+  std::remove( MODEL_PATH );
+
+  std::printf( "Trained on %lu symbols of %lu blocks.\n",
+               trainer.symbol_count(), trainer.block_count() );
+  std::printf( "Encoded length (model id/header): %lu / %lu bits "
+               "( %.2f%% saved ).\n",
+               model_bits, header_bits,
+               100.0 - 100.0 * static_cast< double >( model_bits ) /
+                         static_cast< double >( header_bits ) );
+  std::printf( "Data consistency check after decoding: %s.\n\n\n",
+               ok ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  std::printf( "TRAINED MODEL TESTS:\n\n" );
+
+  try
+  {
+    model_test< coding::num_freq_table >( "num_freq_table" );
+    model_test< coding::num_freq_table_alias >( "alias" );
+  }
+  catch ( std::exception const &e )
+  {
+    std::printf( "Error: %s.\n", e.what() );
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <cstdio>
+
+#include "header_codec.h"
+#include "num_freq_table.h"
+#include "num_freq_table_o1.h"
+#include "rans_order1.h"
+#include "rans_stream.h"
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+// random walk bytes, as read from slowly changing sensor
+block_t< 8 > sensor_block( std::size_t size )
+{
+  auto data = block_t< 8 >( size );
+  coding::uint seed = 12345u;
+  int value = 128;
+  for ( std::size_t i = 0u; i < size; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    value += static_cast< int >( ( seed >> 16u ) % 5u ) - 2;
+    value = value < 0 ? 0 : ( value > 255 ? 255 : value );
+    data.write_symbol( static_cast< coding::byte >( value ) );
+  }
+  data.rewind();
+  return data;
+}
+
+// combined header of all contexts in every format
+template < std::size_t SL, std::size_t NUM >
+bool order1_header_test( coding::num_freq_table_o1< SL, NUM > const &ft )
+{
+  constexpr coding::header_format formats[] = {
+    coding::header_format::raw, coding::header_format::varint,
+    coding::header_format::fibonacci
+  };
+  constexpr char const *format_names[] = { "raw", "varint", "fibonacci" };
+
+  auto ok = true;
+  for ( std::size_t i = 0u; i < 3u; ++i )
+  {
+    auto bits = buffer_t();
+    ft.write_header( bits, formats[ i ] );
+    bits.rewind();
+    auto rft = coding::num_freq_table_o1< SL, NUM >( bits );
+    ok = ok && rft == ft && !bits;
+    std::printf( "Header (%s): %lu bytes.\n", format_names[ i ], bits.size() );
+  }
+  return ok;
+}
+
+template < std::size_t SL, std::size_t NUM >
+void rans_order1_test( char const *name, block_t< SL > &data )
+{
+  std::printf( "=== rANS ORDER-1 TEST (SL = %lu, N = %lu, %s) ===\n\n", SL, NUM,
+               name );
+
+  // order-1
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+  auto stats = coding::rans::encode_order1< NUM >( data, bits );
+  bits.rewind();
+  stats.set_decoding_time( coding::rans::decode_order1< NUM >( bits, dout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+  auto ft = coding::num_freq_table_o1< SL, NUM >( data );
+  std::printf( "Header consistency check: %s.\n\n",
+               order1_header_test( ft ) ? "OK" : "FAILED" );
+  stats.display( "rANS (order-1)" );
+  std::printf( "\n" );
+
+  // order-0 for comparison
+  auto sbits = buffer_t();
+  auto sout = block_t< SL >();
+  auto sstats =
+    coding::rans::encode_forward< NUM, coding::num_freq_table >( data, sbits );
+  sbits.rewind();
+  sstats.set_decoding_time(
+    coding::rans::decode_forward< NUM, coding::num_freq_table >( sbits,
+                                                                  sout ) );
+
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == sout && !sbits ) ? "OK" : "FAILED" );
+  sstats.display( "rANS (order-0)" );
+
+  std::printf( "\nOrder-1 gain: %.2f%% of order-0 size.\n\n\n",
+               100.0 - 100.0 * static_cast< double >( stats.encoded_length() ) /
+                         static_cast< double >( sstats.encoded_length() ) );
+}
+
+template < std::size_t SL, std::size_t NUM >
+void rans_order1_file_test( char const *filepath )
+{
+  auto data = block_t< SL >( filepath );
+  rans_order1_test< SL, NUM >( filepath, data );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  rans_order1_file_test< 2, 12 >( "LICENSE" );
+  rans_order1_file_test< 4, 12 >( "LICENSE" );
+  rans_order1_file_test< 8, 12 >( "LICENSE" );
+  rans_order1_file_test< 8, 12 >( "results/basic_rans_tests_fts.txt" );
+  rans_order1_file_test< 8, 10 >( "results/basic_rans_tests_fts.txt" );
+
+  auto sensor = sensor_block( 1u << 16u );
+  rans_order1_test< 8, 12 >( "sensor", sensor );
+  rans_order1_test< 8, 10 >( "sensor", sensor );
+
+  return 0;
+}
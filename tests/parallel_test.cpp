@@ -0,0 +1,299 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "num_freq_table.h"
+#include "num_freq_table_lookup.h"
+#include "rans_parallel.h"
+#include "thread_pool.h"
+
+constexpr std::size_t DATA_SIZE = 64u << 20u;
+constexpr std::size_t NUM = 12;
+constexpr std::size_t SL = 8;
+constexpr int RUNS = 3;
+
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+// skewed synthetic byte source (roughly geometric distribution)
+void generate_data( block_t &input )
+{
+  coding::ulong state = 0x9e3779b97f4a7c15ul;
+  for ( std::size_t i = 0u; i < DATA_SIZE; ++i )
+  {
+    state ^= state << 13u;
+    state ^= state >> 7u;
+    state ^= state << 17u;
+    auto r = static_cast< coding::uint >( state >> 32u );
+    coding::uint s = 0u;
+    while ( s < 255u && ( r & 3u ) != 0u )
+    {
+      r >>= 2u;
+      ++s;
+    }
+    input.write_symbol( static_cast< coding::byte >( s * 7u ) );
+  }
+  input.rewind();
+}
+
+double mbps( std::chrono::nanoseconds time )
+{
+  return static_cast< double >( DATA_SIZE ) /
+         static_cast< double >( time.count() ) * 1e3;
+}
+
+void parallel_bench( block_t &input, std::size_t thread_count )
+{
+  using coding::num_freq_table_lookup;
+  namespace rans = coding::rans;
+
+  auto pool = coding::thread_pool( thread_count );
+  auto best_enc = std::chrono::nanoseconds::max();
+  auto best_dec = std::chrono::nanoseconds::max();
+  auto ok = true;
+  std::size_t encoded_size = 0u;
+
+  for ( int run = 0; run < RUNS; ++run )
+  {
+    auto encoded = buffer_t( DATA_SIZE );
+    auto output = block_t();
+    input.rewind();
+
+    auto stats =
+      rans::encode_parallel< NUM, num_freq_table_lookup >( input, encoded,
+                                                           pool );
+    auto decoding_time =
+      rans::decode_parallel< NUM, num_freq_table_lookup >( encoded, output,
+                                                           pool );
+
+    best_enc = std::min( best_enc, stats.encoding_time() );
+    best_dec = std::min( best_dec, decoding_time );
+    ok = ok && ( input == output );
+    encoded_size = encoded.size();
+  }
+
+  std::printf( " %3lu %12.2f %12.2f %10.4f   %s\n", thread_count,
+               mbps( best_enc ), mbps( best_dec ),
+               static_cast< double >( encoded_size ) /
+                 static_cast< double >( DATA_SIZE ),
+               ok ? "OK" : "FAILED" );
+}
+
+void range_test( block_t &input )
+{
+  using coding::num_freq_table_lookup;
+  namespace rans = coding::rans;
+
+  auto pool = coding::thread_pool( 1u );
+  auto encoded = buffer_t( DATA_SIZE );
+  input.rewind();
+  rans::encode_parallel< NUM, num_freq_table_lookup >( input, encoded, pool,
+                                                       64u << 10u );
+
+  std::printf( "RANGE DECODING (64 KB blocks):\n\n" );
+  std::printf( "       first      count    time [us]   consistency\n" );
+
+  coding::ulong const ranges[][ 2 ] = { { 0u, 100u },
+                                        { 65530u, 12u },
+                                        { 1000000u, 4096u },
+                                        { 5u << 20u, 300000u },
+                                        { DATA_SIZE - 10u, 100u } };
+  auto slice = block_t();
+  for ( auto const &range : ranges )
+  {
+    auto time = rans::decode_range< NUM, num_freq_table_lookup >(
+      encoded, slice, range[ 0 ], range[ 1 ] );
+
+    auto n = std::min( range[ 1 ], DATA_SIZE - range[ 0 ] );
+    auto ok = slice.symbol_count() == n &&
+              std::memcmp( slice.data(), input.data() + range[ 0 ], n ) == 0;
+    std::printf( " %11lu %10lu %12.2f   %s\n", range[ 0 ], range[ 1 ],
+                 static_cast< double >( time.count() ) * 1e-3,
+                 ok ? "OK" : "FAILED" );
+  }
+
+  auto output = block_t();
+  auto time = rans::decode_parallel< NUM, num_freq_table_lookup >(
+    encoded, output, pool );
+  std::printf( " %11s %10lu %12.2f   %s\n\n", "(full)", DATA_SIZE,
+               static_cast< double >( time.count() ) * 1e-3,
+               ( input == output ) ? "OK" : "FAILED" );
+}
+
+// 12-bit symbols; blocks of 1000 bytes would split symbols, so they are
+//  rounded to whole symbols
+void wide_symbol_test()
+{
+  using coding::num_freq_table_lookup;
+  namespace rans = coding::rans;
+  using wide_block_t = coding::data_block< coding::dynamic_size, 12 >;
+
+  auto input = wide_block_t();
+  coding::uint seed = 12345u;
+  for ( std::size_t i = 0u; i < 100000u; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    input.write_symbol(
+      static_cast< coding::word >( ( seed >> 16u ) % 3000u ) );
+  }
+  input.rewind();
+
+  auto pool = coding::thread_pool( 4u );
+  auto encoded = buffer_t();
+  rans::encode_parallel< 15, num_freq_table_lookup >( input, encoded, pool,
+                                                      1000u );
+
+  // range crossing two blocks
+  auto slice = wide_block_t();
+  rans::decode_range< 15, num_freq_table_lookup >( encoded, slice, 665u,
+                                                   1000u );
+  input.set_position( std::make_pair( ( 665u * 12u ) >> 3u,
+                                      ( 665u * 12u ) & 7u ) );
+  slice.rewind();
+  auto ok = slice.symbol_count() == 1000u;
+  for ( std::size_t i = 0u; i < 1000u; ++i )
+  {
+    ok = ok && slice.read_symbol() == input.read_symbol();
+  }
+  input.rewind();
+
+  auto output = wide_block_t();
+  rans::decode_parallel< 15, num_freq_table_lookup >( encoded, output, pool );
+  ok = ok && input == output;
+
+  std::printf( "WIDE SYMBOL TEST (SL = 12, 1000 byte blocks): %s.\n\n",
+               ok ? "OK" : "FAILED" );
+}
+
+// decodes container bytes with given field overwritten; expects rejection
+bool malformed_container( std::vector< coding::byte > bytes,
+                          std::size_t offset, coding::ulong value,
+                          std::size_t value_size )
+{
+  namespace rans = coding::rans;
+
+  std::memcpy( bytes.data() + offset, &value, value_size );
+  auto src = coding::bit_buffer< coding::read_only_view >( bytes.data(),
+                                                           bytes.size() );
+  src.fast_forward();
+  auto pool = coding::thread_pool( 2u );
+  auto output = block_t();
+  try
+  {
+    rans::decode_parallel< NUM, coding::num_freq_table >( src, output, pool );
+  }
+  catch ( std::invalid_argument const & )
+  {
+    return true;
+  }
+  return false;
+}
+
+void malformed_container_test()
+{
+  namespace rans = coding::rans;
+
+  auto input = block_t();
+  for ( std::size_t i = 0u; i < 5000u; ++i )
+  {
+    input.write_symbol( static_cast< coding::byte >( ( i * i ) % 61u ) );
+  }
+  input.rewind();
+
+  auto pool = coding::thread_pool( 2u );
+  auto encoded = buffer_t();
+  rans::encode_parallel< NUM, coding::num_freq_table >( input, encoded, pool,
+                                                        1000u );
+  auto bytes = std::vector< coding::byte >( encoded.data(),
+                                            encoded.data() + encoded.size() );
+
+  // trailer: streams length, symbol count, block count
+  auto count_at = bytes.size() - sizeof( coding::uint );
+  auto streams_at = count_at - 2u * sizeof( coding::ulong );
+  auto entries_at = streams_at - 5u * sizeof( rans::container_block );
+  auto second_stream_at = entries_at + sizeof( rans::container_block ) +
+                          offsetof( rans::container_block, stream_offset );
+
+  auto ok = !malformed_container( bytes, 0u, bytes[ 0u ], 1u );
+  ok = ok && malformed_container( bytes, count_at, 0xfffffffful,
+                                  sizeof( coding::uint ) );
+  ok = ok && malformed_container( bytes, streams_at, bytes.size(),
+                                  sizeof( coding::ulong ) );
+  ok = ok && malformed_container( bytes, second_stream_at, bytes.size(),
+                                  sizeof( coding::ulong ) );
+  ok = ok && malformed_container( bytes, second_stream_at, 0u,
+                                  sizeof( coding::ulong ) );
+
+  std::printf( "MALFORMED CONTAINER TEST: %s.\n\n", ok ? "OK" : "FAILED" );
+}
+
+void thread_pool_test()
+{
+  auto pool = coding::thread_pool( 4u );
+  std::size_t hits[ 1000 ] = {};
+  pool.run( 1000u, [ & ]( std::size_t i ) { ++hits[ i ]; } );
+  pool.run( 1000u, [ & ]( std::size_t i ) { ++hits[ i ]; } );
+
+  auto ok = true;
+  for ( auto hit : hits )
+  {
+    ok = ok && hit == 2u;
+  }
+
+  auto caught = false;
+  try
+  {
+    pool.run( 10u, []( std::size_t i ) {
+      if ( i == 5u )
+      {
+        throw std::runtime_error( "task failure" );
+      }
+    } );
+  }
+  catch ( std::runtime_error const & )
+  {
+    caught = true;
+  }
+
+  std::printf( "THREAD POOL TEST: %s.\n\n",
+               ( ok && caught ) ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  thread_pool_test();
+  malformed_container_test();
+  wide_symbol_test();
+
+  auto input = block_t( DATA_SIZE );
+  generate_data( input );
+
+  auto max_threads =
+    std::max( static_cast< std::size_t >( std::thread::hardware_concurrency() ),
+              std::size_t{ 1u } );
+
+  std::printf( "BLOCK-PARALLEL rANS (SL = %lu, %lu MB, %lu KB blocks, %s "
+               "decoding, best of %d):\n\n",
+               SL, DATA_SIZE >> 20u,
+               coding::rans::default_parallel_block_size >> 10u,
+               coding::rans::simd_kernel_name( coding::rans::simd_kernel_for(
+                 coding::rans::simd_lanes ) ),
+               RUNS );
+  std::printf( " thr  enc [MB/s]   dec [MB/s]      ratio   consistency\n" );
+
+  for ( std::size_t threads = 1u; threads < max_threads; threads <<= 1u )
+  {
+    parallel_bench( input, threads );
+  }
+  parallel_bench( input, max_threads );
+
+  std::printf( "\n" );
+
+  range_test( input );
+
+  return 0;
+}
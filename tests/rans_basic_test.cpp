@@ -1,10 +1,16 @@
 // #include "bit_buffer.h"
 
 #include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "num_freq_table.h"
 #include "num_freq_table_alias.h"
 #include "rans.h"
+#include "rans_context.h"
+#include "rans_interleaved.h"
 
 template < std::size_t SL, std::size_t N, std::size_t NUM,
            template < std::size_t, std::size_t > class _FreqTable >
@@ -53,6 +59,334 @@ void rans_test( bool show_freq_table, bool verbose )
   std::printf( "\n\n" );
 }
 
+template < std::size_t SL, std::size_t N, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable,
+           std::size_t LANES >
+void rans_interleaved_test()
+{
+  std::printf( "=============================================\n" );
+  std::printf( "=== rANS INTERLEAVED TEST (SL = %lu, x%lu) ===\n", SL, LANES );
+  std::printf( "=============================================\n\n" );
+
+  // prep data blocks (in/out) and intermediate bit buffer
+  auto data = coding::data_block< N, SL >( ".clang-tidy" );
+  auto bits = coding::bit_buffer< 4 * 1024 >();
+  auto dout = coding::data_block< N, SL >();
+
+  // encoding & decoding
+  auto stats =
+    coding::rans::encode_interleaved< NUM, _FreqTable, LANES >( data, bits );
+  auto decoding_time =
+    coding::rans::decode_interleaved< NUM, _FreqTable, LANES >( bits, dout );
+  stats.set_decoding_time( decoding_time );
+
+  // data consistency check
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout ) ? "OK" : "FAILED" );
+
+  // encoding/decoding stats
+  stats.display( "rANS (interleaved)" );
+
+  std::printf( "\n\n" );
+}
+
+template < std::size_t SL, std::size_t N, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+void rans_rcp_test()
+{
+  std::printf( "==============================================\n" );
+  std::printf( "=== rANS DIVISION-FREE ENCODER (SL = %lu) TEST ===\n", SL );
+  std::printf( "==============================================\n\n" );
+
+  // prep data blocks (in/out) and intermediate bit buffers
+  auto data = coding::data_block< N, SL >( ".clang-tidy" );
+  auto bits = coding::bit_buffer< 4 * 1024 >();
+  auto bits_rcp = coding::bit_buffer< 4 * 1024 >();
+  auto dout = coding::data_block< N, SL >();
+  dout.prepare_full();
+
+  // encoding with both encoders
+  auto stats = coding::rans::encode< NUM, _FreqTable >( data, bits );
+  data.rewind();
+  auto stats_rcp =
+    coding::rans::encode_rcp< NUM, _FreqTable >( data, bits_rcp );
+
+  // output identity check
+  auto identical =
+    bits.size() == bits_rcp.size() &&
+    std::memcmp( bits.data(), bits_rcp.data(), bits.size() ) == 0;
+  std::printf( "Encoded output identity check: %s.\n",
+               identical ? "OK" : "FAILED" );
+
+  // decoding division-free output with standard decoder
+  auto decoding_time =
+    coding::rans::decode< NUM, _FreqTable >( bits_rcp, dout );
+  stats_rcp.set_decoding_time( decoding_time );
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout ) ? "OK" : "FAILED" );
+
+  std::printf( "Encoding time (div/rcp): %10li ns / %10li ns\n\n\n",
+               stats.encoding_time().count(),
+               stats_rcp.encoding_time().count() );
+}
+
+template < std::size_t SL, std::size_t N, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+void rans64_test()
+{
+  std::printf( "=============================================\n" );
+  std::printf( "=== rANS 64-BIT STATE TEST (SL = %lu, N = %lu) ===\n", SL,
+               NUM );
+  std::printf( "=============================================\n\n" );
+
+  // prep data blocks (in/out) and intermediate bit buffer
+  auto data = coding::data_block< N, SL >( ".clang-tidy" );
+  auto bits = coding::bit_buffer< 4 * 1024 >();
+  auto dout = coding::data_block< N, SL >();
+  dout.prepare_full();
+
+  // encoding & decoding
+  using policy = coding::rans::rans64;
+  auto stats = coding::rans::encode< NUM, _FreqTable, policy >( data, bits );
+  auto decoding_time =
+    coding::rans::decode< NUM, _FreqTable, policy >( bits, dout );
+  stats.set_decoding_time( decoding_time );
+
+  // data consistency check
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout ) ? "OK" : "FAILED" );
+
+  // encoding/decoding stats
+  stats.display( "rANS (64-bit state)" );
+
+  std::printf( "\n\n" );
+}
+
+template < std::size_t SL, std::size_t NUM,
+           template < std::size_t, std::size_t > class _FreqTable >
+void rans_dynamic_test()
+{
+  std::printf( "=============================================\n" );
+  std::printf( "=== rANS RUNTIME-SIZED BLOCK TEST (SL = %lu) ===\n", SL );
+  std::printf( "=============================================\n\n" );
+
+  // whole file is loaded and buffers grow as needed
+  auto data = coding::data_block< coding::dynamic_size, SL >( "LICENSE" );
+  auto bits = coding::bit_buffer< coding::dynamic_size >();
+  auto dout = coding::data_block< coding::dynamic_size, SL >();
+
+  // encoding & decoding (through moved buffer)
+  auto stats =
+    coding::rans::encode_interleaved< NUM, _FreqTable, 4 >( data, bits );
+  auto moved = std::move( bits );
+  auto decoding_time =
+    coding::rans::decode_interleaved< NUM, _FreqTable, 4 >( moved, dout );
+  stats.set_decoding_time( decoding_time );
+
+  // data consistency check
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && bits.size() == 0u ) ? "OK" : "FAILED" );
+
+  // legacy format decodes into block reserved up front
+  auto legacy_bits = coding::bit_buffer< coding::dynamic_size >( 1024u );
+  auto legacy_dout =
+    coding::data_block< coding::dynamic_size, SL >( data.size() );
+  data.rewind();
+  coding::rans::encode< NUM, _FreqTable >( data, legacy_bits );
+  legacy_dout.prepare_full();
+  coding::rans::decode< NUM, _FreqTable >( legacy_bits, legacy_dout );
+  std::printf( "Data consistency check (legacy format): %s.\n\n",
+               ( data == legacy_dout ) ? "OK" : "FAILED" );
+
+  // encoding/decoding stats
+  stats.display( "rANS (runtime-sized)" );
+
+  std::printf( "\n\n" );
+}
+
+// static model of 2-bit message fields known to both sides; encoded
+//  stream holds no header
+template < template < std::size_t, std::size_t > class _FreqTable >
+void rans_static_test()
+{
+  std::printf( "=============================================\n" );
+  std::printf( "=== rANS STATIC MODEL TEST (SL = 2, N = 12) ===\n" );
+  std::printf( "=============================================\n\n" );
+
+  static constexpr auto model =
+    _FreqTable< 2, 12 >( { 2560u, 1024u, 256u, 256u } );
+  static_assert( model.cdf( 3u ) == 3840u && model.f( 3u ) == 256u,
+                 "static model not built in constant expression" );
+
+  // symbols drawn from model distribution after run of symbols with
+  //  cdf 0, which leave state at its initial value
+  const std::size_t count = 4096u;
+  auto data = coding::data_block< coding::dynamic_size, 2 >();
+  coding::uint seed = 4242u;
+  for ( std::size_t i = 0u; i < 3u; ++i )
+  {
+    data.write_symbol( 0u );
+  }
+  for ( std::size_t i = 3u; i < count; ++i )
+  {
+    seed = seed * 1103515245u + 12345u;
+    data.write_symbol( model.symbol(
+      static_cast< coding::word >( ( seed >> 16u ) & model.num_mask() ) ) );
+  }
+
+  auto bits = coding::bit_buffer< coding::dynamic_size >();
+  auto dout = coding::data_block< coding::dynamic_size, 2 >();
+  auto stats = coding::rans::encode< 12, _FreqTable >( model, data, bits );
+  dout.prepare( count );
+  stats.set_decoding_time(
+    coding::rans::decode< 12, _FreqTable >( model, bits, dout ) );
+
+  // same data with table counted and sent in header
+  auto header_bits = coding::bit_buffer< coding::dynamic_size >();
+  data.rewind();
+  auto header_stats =
+    coding::rans::encode< 12, _FreqTable >( data, header_bits );
+
+  // decoded block is cleared by prepare(), so leading zeros must also be
+  //  written back up to its beginning
+  auto ok = data == dout && dout.is_beg() && bits.is_beg();
+
+  // symbol of zero frequency could not be coded, model is rejected
+  try
+  {
+    coding::word const zero_freqs[] = { 3072u, 1024u, 0u, 0u };
+    _FreqTable< 2, 12 >{ zero_freqs };
+    ok = false;
+  }
+  catch ( std::invalid_argument const & )
+  {
+  }
+
+  std::printf( "Data consistency check after decoding: %s.\n",
+               ok ? "OK" : "FAILED" );
+  std::printf( "Encoded length (static/counted): %lu / %lu bits.\n\n",
+               stats.encoded_length(), header_stats.encoded_length() );
+
+  stats.display( "rANS (static model)" );
+
+  std::printf( "\n\n" );
+}
+
+// stream of small blocks coded by context reused between blocks and by
+//  separate calls; streams must be same
+template < template < std::size_t, std::size_t > class _FreqTable >
+void rans_context_test()
+{
+  std::printf( "=====================================================\n" );
+  std::printf( "=== rANS CONTEXT TEST (SL = 8, N = 12, 4096 x 256) ===\n" );
+  std::printf( "=====================================================\n\n" );
+
+  using block_t = coding::data_block< coding::dynamic_size, 8 >;
+  using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+  // every other block has symbols of previous one reversed, so that its
+  //  table is that of previous one; blocks start with rare symbol ( lowest
+  //  one could not be told from initial state of legacy format )
+  const std::size_t count = 4096u;
+  const std::size_t size = 256u;
+  auto blocks = std::vector< block_t >( count );
+  auto symbols = std::vector< coding::byte >( size - 1u );
+  coding::uint seed = 99u;
+  for ( std::size_t i = 0u; i < count; i += 2u )
+  {
+    auto range = i % 4u == 0u ? 64u : 32u;
+    for ( auto &s : symbols )
+    {
+      seed = seed * 1103515245u + 12345u;
+      s = static_cast< coding::byte >( 'A' + ( seed >> 16u ) % range );
+    }
+    blocks[ i ].write_symbol( '~' );
+    blocks[ i + 1u ].write_symbol( '~' );
+    for ( std::size_t j = 0u; j < size - 1u; ++j )
+    {
+      blocks[ i ].write_symbol( symbols[ j ] );
+      blocks[ i + 1u ].write_symbol( symbols[ size - 2u - j ] );
+    }
+  }
+
+  auto ok = true;
+  auto context = coding::rans::codec_context< 8, 12, _FreqTable >();
+  auto bits = buffer_t();
+  auto call_bits = buffer_t();
+  auto context_time = std::chrono::nanoseconds( 0 );
+  auto call_time = std::chrono::nanoseconds( 0 );
+  for ( auto &data : blocks )
+  {
+    bits.reset();
+    data.rewind();
+    auto stats = context.encode( data, bits );
+    auto dout = block_t();
+    dout.prepare( data.symbol_count() );
+    stats.set_decoding_time( context.decode( bits, dout ) );
+    context_time += stats.encoding_time() + stats.decoding_time();
+
+    call_bits.reset();
+    data.rewind();
+    auto call_stats = coding::rans::encode< 12, _FreqTable >( data, call_bits );
+    auto call_dout = block_t();
+    call_dout.prepare( data.symbol_count() );
+    call_stats.set_decoding_time(
+      coding::rans::decode< 12, _FreqTable >( call_bits, call_dout ) );
+    call_time += call_stats.encoding_time() + call_stats.decoding_time();
+
+    ok = ok && data == dout && bits.size() == call_bits.size() &&
+         std::memcmp( bits.data(), call_bits.data(), bits.size() ) == 0 &&
+         stats.header_length() == call_stats.header_length();
+  }
+
+  std::printf( "Data consistency check after decoding: %s.\n",
+               ok ? "OK" : "FAILED" );
+  std::printf( "Coding time (context/calls): %.3f / %.3f ms.\n\n\n",
+               static_cast< double >( context_time.count() ) * 1e-6,
+               static_cast< double >( call_time.count() ) * 1e-6 );
+}
+
+// stream written before header formats, table header being raw dump of
+//  C(S); truncated one is rejected
+template < template < std::size_t, std::size_t > class _FreqTable >
+void rans_legacy_test()
+{
+  std::printf( "========================================\n" );
+  std::printf( "=== rANS LEGACY HEADER TEST (SL = 8) ===\n" );
+  std::printf( "========================================\n\n" );
+
+  using block_t = coding::data_block< coding::dynamic_size, 8 >;
+  auto data = block_t( ".clang-tidy" );
+  auto ft = _FreqTable< 8, 12 >( data );
+  auto bits = coding::bit_buffer< coding::dynamic_size >();
+  coding::rans::detail::encode_symbols< 12, coding::rans::rans32 >( ft, data,
+                                                                   bits );
+  for ( std::size_t i = 0u; i < ft.size(); ++i )
+  {
+    bits.write_word( static_cast< coding::word >( ft.cdf( i ) ) );
+  }
+
+  auto dout = block_t();
+  dout.prepare( data.symbol_count() );
+  coding::rans::decode_legacy< 12, _FreqTable >( bits, dout );
+  data.rewind();
+  auto ok = data == dout && dout.is_beg() && bits.is_beg();
+
+  auto short_bits = coding::bit_buffer< coding::dynamic_size >();
+  short_bits.write_word( 0u );
+  try
+  {
+    coding::rans::decode_legacy< 12, _FreqTable >( short_bits, dout );
+    ok = false;
+  }
+  catch ( std::invalid_argument const & )
+  {
+  }
+
+  std::printf( "Data consistency check after decoding: %s.\n\n\n",
+               ok ? "OK" : "FAILED" );
+}
+
 int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
 {
   std::printf( "rANS TESTS:\n\n" );
@@ -73,18 +407,93 @@ int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
 
 
 
-  // std::printf( "rANS (ALIAS) TESTS:\n\n" );
+  std::printf( "rANS (INTERLEAVED) TESTS:\n\n" );
+
+  rans_interleaved_test< 1, N, NUM, coding::num_freq_table, 2 >();
+  rans_interleaved_test< 2, N, NUM, coding::num_freq_table, 4 >();
+  rans_interleaved_test< 4, N, NUM, coding::num_freq_table, 8 >();
+  rans_interleaved_test< 8, N, NUM, coding::num_freq_table, 2 >();
+  rans_interleaved_test< 8, N, NUM, coding::num_freq_table, 4 >();
+  rans_interleaved_test< 8, N, NUM, coding::num_freq_table, 8 >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (DIVISION-FREE) TESTS:\n\n" );
+
+  rans_rcp_test< 1, N, NUM, coding::num_freq_table >();
+  rans_rcp_test< 2, N, NUM, coding::num_freq_table >();
+  rans_rcp_test< 4, N, NUM, coding::num_freq_table >();
+  rans_rcp_test< 8, N, NUM, coding::num_freq_table >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (64-BIT STATE) TESTS:\n\n" );
+
+  rans64_test< 1, N, NUM, coding::num_freq_table >();
+  rans64_test< 2, N, NUM, coding::num_freq_table >();
+  rans64_test< 4, N, NUM, coding::num_freq_table >();
+  rans64_test< 8, N, NUM, coding::num_freq_table >();
+  rans64_test< 8, N, 20, coding::num_freq_table >();
+  rans64_test< 8, N, 31, coding::num_freq_table >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (RUNTIME-SIZED BLOCK) TESTS:\n\n" );
+
+  rans_dynamic_test< 4, NUM, coding::num_freq_table >();
+  rans_dynamic_test< 8, NUM, coding::num_freq_table >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (ALIAS) TESTS:\n\n" );
+
+  rans_test< 1, N, NUM, coding::num_freq_table_alias >( show_freq_table,
+                                                        verbose );
+  rans_test< 2, N, NUM, coding::num_freq_table_alias >( show_freq_table,
+                                                        verbose );
+  rans_test< 4, N, NUM, coding::num_freq_table_alias >( show_freq_table,
+                                                        verbose );
+  rans_test< 8, N, NUM, coding::num_freq_table_alias >( show_freq_table,
+                                                        verbose );
+  rans_interleaved_test< 8, N, NUM, coding::num_freq_table_alias, 4 >();
+  rans_rcp_test< 8, N, NUM, coding::num_freq_table_alias >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (STATIC MODEL) TESTS:\n\n" );
+
+  rans_static_test< coding::num_freq_table >();
+  rans_static_test< coding::num_freq_table_alias >();
+
+  std::printf( "\n\n" );
 
-  // rans_test< 1, N, NUM, coding::num_freq_table_alias >(
-  //  show_freq_table );  // , verbose );
-  // rans_test< 2, N, NUM, coding::num_freq_table_alias >(
-  //  show_freq_table );  //, verbose );
-  // rans_test< 4, N, NUM, coding::num_freq_table_alias >(
-  //  show_freq_table );  //, verbose );
-  // rans_test< 8, N, NUM, coding::num_freq_table_alias >(
-  //  show_freq_table );  //, verbose );
 
-  std::printf( "\n" );
+
+  std::printf( "rANS (CONTEXT) TESTS:\n\n" );
+
+  rans_context_test< coding::num_freq_table >();
+  rans_context_test< coding::num_freq_table_alias >();
+
+  std::printf( "\n\n" );
+
+
+
+  std::printf( "rANS (LEGACY HEADER) TESTS:\n\n" );
+
+  rans_legacy_test< coding::num_freq_table >();
+  rans_legacy_test< coding::num_freq_table_alias >();
+
+  std::printf( "\n\n" );
 
 
   return 0;
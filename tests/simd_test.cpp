@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstdio>
+
+#include "num_freq_table.h"
+#include "num_freq_table_lookup.h"
+#include "rans.h"
+#include "rans_interleaved.h"
+#include "rans_simd.h"
+
+constexpr std::size_t DATA_SIZE = 1u << 20u;
+constexpr std::size_t BUF_SIZE = 2u << 20u;
+constexpr std::size_t NUM = 12;
+constexpr std::size_t SL = 8;
+constexpr int RUNS = 5;
+
+using block_t = coding::data_block< DATA_SIZE, SL >;
+using buffer_t = coding::bit_buffer< BUF_SIZE >;
+
+static block_t input;
+static block_t output;
+static buffer_t encoded;
+
+// skewed synthetic byte source (roughly geometric distribution)
+void generate_data()
+{
+  coding::ulong state = 0x9e3779b97f4a7c15ul;
+  for ( std::size_t i = 0u; i < DATA_SIZE; ++i )
+  {
+    state ^= state << 13u;
+    state ^= state >> 7u;
+    state ^= state << 17u;
+    auto r = static_cast< coding::uint >( state >> 32u );
+    coding::uint s = 0u;
+    while ( s < 255u && ( r & 3u ) != 0u )
+    {
+      r >>= 2u;
+      ++s;
+    }
+    input.write_symbol( static_cast< coding::byte >( s * 7u ) );
+  }
+  input.rewind();
+}
+
+template < typename _Encode, typename _Decode >
+void decode_bench( char const *name, _Encode encode, _Decode decode )
+{
+  auto best = std::chrono::nanoseconds::max();
+  auto ok = true;
+  for ( int run = 0; run < RUNS; ++run )
+  {
+    input.rewind();
+    encoded.reset();
+    output.reset();
+    output.prepare_full();
+    encode();
+    auto time = decode();
+    best = time < best ? time : best;
+    ok = ok && ( input == output );
+  }
+
+  auto mbps = static_cast< double >( DATA_SIZE ) /
+              static_cast< double >( best.count() ) * 1e3;
+  std::printf( " %-28s %10li ns  %9.2f MB/s   (consistency: %s)\n", name,
+               best.count(), mbps, ok ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  generate_data();
+
+  std::printf( "SIMD rANS DECODER TESTS (SL = %lu, %lu KB, best of %d):\n\n",
+               SL, DATA_SIZE >> 10u, RUNS );
+
+  using coding::num_freq_table;
+  using coding::num_freq_table_lookup;
+  namespace rans = coding::rans;
+
+  auto encode = [] { rans::encode< NUM, num_freq_table >( input, encoded ); };
+  auto encode_x4 = [] {
+    rans::encode_interleaved< NUM, num_freq_table, 4 >( input, encoded );
+  };
+  auto encode_x8 = [] {
+    rans::encode_interleaved< NUM, num_freq_table, 8 >( input, encoded );
+  };
+
+  decode_bench( "scalar (linear scan)", encode, [] {
+    return rans::decode< NUM, num_freq_table >( encoded, output );
+  } );
+  decode_bench( "scalar (slot lookup)", encode, [] {
+    return rans::decode< NUM, num_freq_table_lookup >( encoded, output );
+  } );
+  decode_bench( "interleaved x4 (slot lookup)", encode_x4, [] {
+    return rans::decode_interleaved< NUM, num_freq_table_lookup, 4 >( encoded,
+                                                                      output );
+  } );
+  decode_bench( "interleaved x8 (slot lookup)", encode_x8, [] {
+    return rans::decode_interleaved< NUM, num_freq_table_lookup, 8 >( encoded,
+                                                                      output );
+  } );
+  decode_bench( "simd fallback x4", encode_x4, [] {
+    return rans::decode_simd_fallback< NUM, num_freq_table, 4 >( encoded,
+                                                                 output );
+  } );
+  decode_bench( "simd fallback x8", encode_x8, [] {
+    return rans::decode_simd_fallback< NUM, num_freq_table, 8 >( encoded,
+                                                                 output );
+  } );
+  // labelled by kernel chosen on this processor
+  char x4_name[ 32 ];
+  char x8_name[ 32 ];
+  std::snprintf( x4_name, sizeof( x4_name ), "simd x4 (%s)",
+                 rans::simd_kernel_name( rans::simd_kernel_for( 4u ) ) );
+  std::snprintf( x8_name, sizeof( x8_name ), "simd x8 (%s)",
+                 rans::simd_kernel_name( rans::simd_kernel_for( 8u ) ) );
+  decode_bench( x4_name, encode_x4, [] {
+    return rans::decode_simd< NUM, num_freq_table, 4 >( encoded, output );
+  } );
+  decode_bench( x8_name, encode_x8, [] {
+    return rans::decode_simd< NUM, num_freq_table, 8 >( encoded, output );
+  } );
+
+  std::printf( "\n" );
+
+  return 0;
+}
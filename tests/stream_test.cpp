@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "num_freq_table.h"
+#include "num_freq_table_lookup.h"
+#include "rans_stream.h"
+
+constexpr std::size_t NUM = 12;
+
+using buffer_t = coding::bit_buffer< coding::dynamic_size >;
+
+template < std::size_t SL >
+using block_t = coding::data_block< coding::dynamic_size, SL >;
+
+template < std::size_t SL,
+           template < std::size_t, std::size_t > class _FreqTable >
+void rans_forward_test()
+{
+  std::printf( "=============================================\n" );
+  std::printf( "=== rANS FORWARD LAYOUT TEST (SL = %lu) ===\n", SL );
+  std::printf( "=============================================\n\n" );
+
+  auto data = block_t< SL >( "LICENSE" );
+  auto bits = buffer_t();
+  auto dout = block_t< SL >();
+
+  // encoding & decoding
+  auto stats = coding::rans::encode_forward< NUM, _FreqTable >( data, bits );
+  bits.rewind();
+  auto decoding_time =
+    coding::rans::decode_forward< NUM, _FreqTable >( bits, dout );
+  stats.set_decoding_time( decoding_time );
+
+  // data consistency check
+  std::printf( "Data consistency check after decoding: %s.\n\n",
+               ( data == dout && !bits ) ? "OK" : "FAILED" );
+
+  // encoding/decoding stats
+  stats.display( "rANS (forward)" );
+
+  std::printf( "\n\n" );
+}
+
+// input is handed to decoder in chunks of 7 bytes, symbols are taken out in
+//  chunks of 100
+template < std::size_t SL >
+void rans_stream_test()
+{
+  std::printf( "=== rANS STREAMING DECODER TEST (SL = %lu) ===\n\n", SL );
+
+  auto data = block_t< SL >( ".clang-tidy" );
+  auto bits = buffer_t();
+  coding::rans::encode_forward< NUM, coding::num_freq_table_lookup >( data,
+                                                                      bits );
+
+  std::size_t pos = 0u;
+  auto reader = [ & ]( void *dst_p, std::size_t n ) {
+    n = std::min( { n, std::size_t{ 7u }, bits.size() - pos } );
+    std::memcpy( dst_p, bits.data() + pos, n );
+    pos += n;
+    return n;
+  };
+
+  auto decoder =
+    coding::rans::stream_decoder< NUM, coding::num_freq_table_lookup, SL,
+                                  16u >( reader );
+  auto chunk = block_t< SL >();
+  auto ok = decoder.remaining() == data.symbol_count();
+  while ( decoder )
+  {
+    chunk.reset();
+    auto n = decoder.decode( chunk, 100u );
+    chunk.rewind();
+    for ( std::size_t i = 0u; i < n; ++i )
+    {
+      ok = ok && chunk.read_symbol() == data.read_symbol();
+    }
+  }
+  std::printf( "Chunked memory reader: %s.\n", ok ? "OK" : "FAILED" );
+
+  // same stream through pipe
+  int fds[ 2 ];
+  ok = ::pipe( fds ) == 0 &&
+       ::write( fds[ 1 ], bits.data(), bits.size() ) ==
+         static_cast< ssize_t >( bits.size() );
+  ::close( fds[ 1 ] );
+
+  auto pipe_decoder =
+    coding::rans::stream_decoder< NUM, coding::num_freq_table_lookup, SL >(
+      coding::rans::fd_reader( fds[ 0 ] ) );
+  auto dout = block_t< SL >();
+  pipe_decoder.decode( dout, pipe_decoder.remaining() );
+  ::close( fds[ 0 ] );
+
+  data.rewind();
+  std::printf( "File descriptor reader: %s.\n\n",
+               ( ok && data == dout ) ? "OK" : "FAILED" );
+}
+
+int main( [[maybe_unused]] int argc, [[maybe_unused]] char const *argv[] )
+{
+  std::printf( "rANS (FORWARD LAYOUT) TESTS:\n\n" );
+
+  rans_forward_test< 1, coding::num_freq_table >();
+  rans_forward_test< 2, coding::num_freq_table >();
+  rans_forward_test< 4, coding::num_freq_table >();
+  rans_forward_test< 8, coding::num_freq_table >();
+  rans_forward_test< 8, coding::num_freq_table_lookup >();
+
+  std::printf( "\n\n" );
+
+  rans_stream_test< 1 >();
+  rans_stream_test< 4 >();
+  rans_stream_test< 8 >();
+
+  return 0;
+}
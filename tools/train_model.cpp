@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+#include "mapped_file.h"
+#include "model_file.h"
+#include "num_freq_table.h"
+
+// byte model of files given on command line, coded with numeral base 2^12
+//  ( cf. rans::encode with model set )
+constexpr std::size_t NUM = 12;
+
+int main( int argc, char const *argv[] )
+{
+  if ( argc < 4 )
+  {
+    std::fprintf( stderr,
+                  "usage: %s <model file> <model id> <sample file>...\n",
+                  argv[ 0 ] );
+    return 2;
+  }
+
+  char *end_p = nullptr;
+  auto id = std::strtoul( argv[ 2 ], &end_p, 10 );
+  if ( *end_p != '\0' || id > 0xffffffffu )
+  {
+    std::fprintf( stderr, "invalid model id: %s\n", argv[ 2 ] );
+    return 2;
+  }
+
+  try
+  {
+    auto trainer = coding::model_trainer< 8 >();
+    for ( int i = 3; i < argc; ++i )
+    {
+      auto file = coding::mapped_file( argv[ i ] );
+      auto data = file.view< 8 >();
+      trainer.add( data );
+    }
+
+    auto model = trainer.build< NUM, coding::num_freq_table >();
+    coding::save_model( argv[ 1 ], static_cast< coding::uint >( id ), model );
+
+    std::printf( "Model %lu trained on %lu symbols of %lu files: %s ( %u "
+                 "bytes of header ).\n",
+                 id, trainer.symbol_count(), trainer.block_count(),
+                 argv[ 1 ], model.header_length() >> 3u );
+  }
+  catch ( std::exception const &e )
+  {
+    std::fprintf( stderr, "error: %s\n", e.what() );
+    return 1;
+  }
+
+  return 0;
+}